@@ -14,14 +14,16 @@ namespace core
 {
     class IOperand;
     class IInstruction;
+    struct DecodedInstruction;
     class IEvent;
     class IMicroOp;
     class IDevice;
 
     using PIOperand = std::shared_ptr<IOperand>;
     using PIInstruction = std::shared_ptr<IInstruction>;
-    using PIEvent = std::shared_ptr<IEvent>;
-    using PIMicroOp = std::shared_ptr<IMicroOp>;
+    using PIEvent = std::unique_ptr<IEvent>;
+    // Micro-ops are owned by the MicroOpArena they were built in and live until it is reset.
+    using PIMicroOp = IMicroOp *;
     using PIDevice = std::shared_ptr<IDevice>;
 
     using SymbolTable = std::map<std::string, uint32_t>;
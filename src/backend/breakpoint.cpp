@@ -0,0 +1,153 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include "breakpoint.h"
+
+#include <cctype>
+#include <cstdlib>
+
+#include "device_regs.h"
+#include "state.h"
+
+using namespace lc3::core;
+
+namespace
+{
+    // Parses a whole string as a number written either as in the assembler or as in C.
+    bool parseValue(std::string const & str, uint16_t & value)
+    {
+        size_t pos = 0;
+        bool negative = false;
+        if(pos < str.size() && str[pos] == '#') { pos += 1; }
+        if(pos < str.size() && str[pos] == '-') {
+            negative = true;
+            pos += 1;
+        }
+
+        int base = 10;
+        if(str.compare(pos, 2, "0x") == 0) {
+            base = 16;
+            pos += 2;
+        } else if(pos < str.size() && str[pos] == 'x') {
+            base = 16;
+            pos += 1;
+        }
+
+        if(pos == str.size() || ! std::isxdigit(static_cast<unsigned char>(str[pos]))) { return false; }
+
+        char * end = nullptr;
+        unsigned long magnitude = std::strtoul(str.c_str() + pos, &end, base);
+        if(*end != '\0' || magnitude > (negative ? 0x8000ul : 0xFFFFul)) { return false; }
+
+        value = static_cast<uint16_t>(negative ? 0x10000ul - magnitude : magnitude);
+        return true;
+    }
+};
+
+bool BreakCondition::evaluate(MachineState const & state) const
+{
+    uint16_t actual = 0;
+    switch(operand) {
+        case Operand::NONE: return true;
+        case Operand::REG: actual = state.readReg(index); break;
+        case Operand::PC: actual = state.readPC(); break;
+        case Operand::MEM: actual = std::get<0>(state.readMem(index)); break;
+    }
+
+    int32_t lhs = operand == Operand::PC ? actual : static_cast<int16_t>(actual);
+    int32_t rhs = operand == Operand::PC ? value : static_cast<int16_t>(value);
+    switch(compare) {
+        case Compare::EQ: return lhs == rhs;
+        case Compare::NE: return lhs != rhs;
+        case Compare::LT: return lhs < rhs;
+        case Compare::LE: return lhs <= rhs;
+        case Compare::GT: return lhs > rhs;
+        case Compare::GE: return lhs >= rhs;
+    }
+    return false;
+}
+
+std::string BreakCondition::toString(void) const
+{
+    std::string lhs;
+    switch(operand) {
+        case Operand::NONE: return "";
+        case Operand::REG: lhs = lc3::utils::ssprintf("R%d", index); break;
+        case Operand::PC: lhs = "PC"; break;
+        case Operand::MEM: lhs = lc3::utils::ssprintf("MEM[0x%0.4hX]", index); break;
+    }
+
+    char const * op = "==";
+    switch(compare) {
+        case Compare::EQ: op = "=="; break;
+        case Compare::NE: op = "!="; break;
+        case Compare::LT: op = "<"; break;
+        case Compare::LE: op = "<="; break;
+        case Compare::GT: op = ">"; break;
+        case Compare::GE: op = ">="; break;
+    }
+
+    return lc3::utils::ssprintf("%s %s 0x%0.4hX", lhs.c_str(), op, value);
+}
+
+lc3::optional<BreakCondition> BreakCondition::parse(std::string const & str)
+{
+    std::string compact;
+    for(char c : str) {
+        if(! std::isspace(static_cast<unsigned char>(c))) {
+            compact.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        }
+    }
+
+    BreakCondition condition;
+    if(compact.empty()) { return condition; }
+
+    size_t pos = 0;
+    if(compact.compare(0, 4, "mem[") == 0) {
+        size_t close = compact.find(']');
+        if(close == std::string::npos || ! parseValue(compact.substr(4, close - 4), condition.index) ||
+            condition.index >= MMIO_START)
+        {
+            return {};
+        }
+        condition.operand = Operand::MEM;
+        pos = close + 1;
+    } else if(compact.compare(0, 2, "pc") == 0) {
+        condition.operand = Operand::PC;
+        pos = 2;
+    } else if(compact.size() >= 2 && compact[0] == 'r' && '0' <= compact[1] && compact[1] <= '7') {
+        condition.operand = Operand::REG;
+        condition.index = static_cast<uint16_t>(compact[1] - '0');
+        pos = 2;
+    } else {
+        return {};
+    }
+
+    struct { char const * text; Compare compare; } const ops[] = {
+        { "==", Compare::EQ }, { "!=", Compare::NE }, { "<=", Compare::LE }, { ">=", Compare::GE },
+        { "<", Compare::LT }, { ">", Compare::GT }, { "=", Compare::EQ }
+    };
+    bool found = false;
+    for(auto const & op : ops) {
+        std::string text(op.text);
+        if(compact.compare(pos, text.size(), text) == 0) {
+            condition.compare = op.compare;
+            pos += text.size();
+            found = true;
+            break;
+        }
+    }
+
+    if(! found || ! parseValue(compact.substr(pos), condition.value)) { return {}; }
+
+    return condition;
+}
+
+std::string lc3::core::watchTypeToString(WatchType type)
+{
+    switch(type) {
+        case WatchType::READ: return "read";
+        case WatchType::WRITE: return "write";
+        default: return "access";
+    }
+}
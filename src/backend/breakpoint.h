@@ -0,0 +1,90 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#ifndef BREAKPOINT_H
+#define BREAKPOINT_H
+
+#include <cstdint>
+#include <string>
+
+#include "utils.h"
+
+namespace lc3
+{
+namespace core
+{
+    class MachineState;
+
+    // A comparison between a register, the PC, or a memory location and a constant, e.g. "R0 == x10" or
+    // "MEM[x4000] < #0".  Registers and memory are compared as signed values and the PC as an unsigned one.
+    struct BreakCondition
+    {
+        enum class Operand { NONE, REG, PC, MEM };
+        enum class Compare { EQ, NE, LT, LE, GT, GE };
+
+        Operand operand;
+        uint16_t index;         // register number or memory address
+        Compare compare;
+        uint16_t value;
+
+        BreakCondition(void) : operand(Operand::NONE), index(0), compare(Compare::EQ), value(0) { }
+
+        // A condition without an operand always holds.
+        bool evaluate(MachineState const & state) const;
+        std::string toString(void) const;
+
+        // Accepts "<R0-R7|PC|MEM[addr]> <op> <value>", where op is one of == != < <= > >= and numbers are written
+        // as in the assembler (x3000, #-1) or C (0x3000, -1).  An empty string is a condition that always holds.
+        static optional<BreakCondition> parse(std::string const & str);
+    };
+
+    struct Breakpoint
+    {
+        uint16_t addr;
+        BreakCondition condition;
+        uint64_t ignore_count;      // number of hits that do not stop the run
+        uint64_t hit_count;         // number of times the breakpoint was reached with its condition holding
+
+        Breakpoint(void) : addr(0), ignore_count(0), hit_count(0) { }
+    };
+
+    enum class WatchType
+    {
+          READ = 1
+        , WRITE = 2
+        , ACCESS = 3
+    };
+
+    // Loads and stores made by instructions within [start, end] stop the run after the instruction that made them.
+    // Only memory outside the device register page can be watched.
+    struct Watchpoint
+    {
+        uint32_t id;
+        uint16_t start, end;
+        WatchType type;
+        BreakCondition condition;
+        uint64_t ignore_count;
+        uint64_t hit_count;
+
+        Watchpoint(void) : id(0), start(0), end(0), type(WatchType::ACCESS), ignore_count(0), hit_count(0) { }
+    };
+
+    // What stopped the last run, if it was a breakpoint or a watchpoint.
+    struct BreakHit
+    {
+        enum class Kind { NONE, BREAKPOINT, WATCHPOINT };
+
+        Kind kind;
+        uint16_t pc;            // address of the breakpoint, or of the instruction that triggered the watchpoint
+        uint32_t watch_id;
+        uint16_t addr;          // first watched address that was accessed
+        bool write;
+
+        BreakHit(void) : kind(Kind::NONE), pc(0), watch_id(0), addr(0), write(false) { }
+    };
+
+    std::string watchTypeToString(WatchType type);
+};
+};
+
+#endif
@@ -4,6 +4,7 @@
 #ifndef CALLBACK_H
 #define CALLBACK_H
 
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <string>
@@ -34,6 +35,42 @@ namespace core
 
     std::string callbackTypeToString(CallbackType type);
     CallbackTypeUnderlying callbackTypeToUnderlying(CallbackType type);
+
+    // Callback handlers by type, along with a mask of the types that have one, so that finding out that nobody is
+    // listening costs a single test.
+    template<typename Callback>
+    class CallbackRegistry
+    {
+    public:
+        CallbackRegistry(void) : mask(0) { }
+
+        static uint32_t typeBit(CallbackType type) { return 1u << index(type); }
+
+        void set(CallbackType type, Callback func)
+        {
+            if(type == CallbackType::INVALID) { return; }
+
+            if(func != nullptr) {
+                mask |= typeBit(type);
+            } else {
+                mask &= ~typeBit(type);
+            }
+            handlers[index(type)] = func;
+        }
+        bool has(CallbackType type) const { return (mask & typeBit(type)) != 0; }
+        uint32_t getMask(void) const { return mask; }
+        // Only valid if has(type).
+        Callback const & get(CallbackType type) const { return handlers[index(type)]; }
+
+    private:
+        static constexpr CallbackTypeUnderlying FIRST = static_cast<CallbackTypeUnderlying>(CallbackType::BREAKPOINT);
+        static constexpr size_t COUNT = static_cast<CallbackTypeUnderlying>(CallbackType::INVALID) - FIRST;
+
+        std::array<Callback, COUNT> handlers;
+        uint32_t mask;
+
+        static size_t index(CallbackType type) { return static_cast<CallbackTypeUnderlying>(type) - FIRST; }
+    };
 };
 };
 
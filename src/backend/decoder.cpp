@@ -1,53 +1,76 @@
 /*
  * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
  */
+#include <vector>
+
 #include "decoder.h"
 
 using namespace lc3::core::sim;
 
-Decoder::Decoder(void) : ISAHandler()
+namespace
 {
-    for(PIInstruction inst : instructions) {
-        uint16_t opcode = inst->getOperand(0)->getValue();
-        instructions_by_opcode[opcode].push_back(inst);
+    lc3::core::DecodedInstruction decodeValue(lc3::core::IInstruction const * inst, uint16_t value)
+    {
+        using namespace lc3::utils;
+
+        lc3::core::DecodedInstruction ret;
+        ret.inst = inst;
+        ret.value = value;
+        ret.opcode = static_cast<uint8_t>(getBits(value, 15, 12));
+        ret.dr = static_cast<uint8_t>(getBits(value, 11, 9));
+        ret.sr1 = static_cast<uint8_t>(getBits(value, 8, 6));
+        ret.sr2 = static_cast<uint8_t>(getBits(value, 2, 0));
+        ret.imm_mode = getBit(value, 5) == 1;
+        ret.pc_relative = getBit(value, 11) == 1;
+        ret.trapvect8 = static_cast<uint8_t>(getBits(value, 7, 0));
+        ret.imm5 = sextTo16(getBits(value, 4, 0), 5);
+        ret.offset6 = sextTo16(getBits(value, 5, 0), 6);
+        ret.pcoffset9 = sextTo16(getBits(value, 8, 0), 9);
+        ret.pcoffset11 = sextTo16(getBits(value, 10, 0), 11);
+        return ret;
     }
-}
 
-lc3::optional<lc3::core::PIInstruction> Decoder::decode(uint16_t value) const
-{
-    auto search = instructions_by_opcode.find(lc3::utils::getBits(value, 15, 12));
-    bool valid = false;
-
-    if(search != instructions_by_opcode.end()) {
-        // Search instructions with the same opcode for a match.
-        for(PIInstruction inst : search->second) {
-            uint32_t bit_check_pos = 15;
-            valid = true;
-            // Scan over all fixed operands in instruction to determine if there's a match.
-            for(PIOperand const op : inst->getOperands()) {
-                if(op->getType() == IOperand::Type::FIXED) {
-                    if(lc3::utils::getBits(value, bit_check_pos, bit_check_pos - op->getWidth() + 1) !=
-                        op->getValue())
-                    {
-                        valid = false;
-                        break;
-                    }
+    std::vector<lc3::core::DecodedInstruction> buildDecodeTable(void)
+    {
+        lc3::core::ISAHandler const & isa = lc3::core::ISAHandler::get();
+
+        std::vector<lc3::core::DecodedInstruction> table(1 << 16);
+        std::vector<std::pair<uint16_t, uint16_t>> patterns;
+        for(lc3::core::PIInstruction inst : isa.getInstructions()) {
+            // Build a mask and expected value out of the fixed operands of each instruction.
+            uint16_t mask = 0, match = 0;
+            uint32_t bit_pos = 15;
+            for(lc3::core::PIOperand const op : inst->getOperands()) {
+                uint32_t shift = bit_pos - op->getWidth() + 1;
+                if(op->getType() == lc3::core::IOperand::Type::FIXED) {
+                    uint16_t field_mask = static_cast<uint16_t>(((1 << op->getWidth()) - 1) << shift);
+                    mask |= field_mask;
+                    match |= static_cast<uint16_t>(op->getValue() << shift) & field_mask;
                 }
-                bit_check_pos -= op->getWidth();
+                bit_pos -= op->getWidth();
             }
+            patterns.emplace_back(mask, match);
+        }
 
-            if(valid) {
-                uint32_t bit_pos = 15;
-                for(PIOperand op : inst->getOperands()) {
-                    if(op->getType() != IOperand::Type::FIXED) {
-                        op->setValue(lc3::utils::getBits(value, bit_pos, bit_pos - op->getWidth() + 1));
-                    }
-                    bit_pos -= op->getWidth();
+        std::vector<lc3::core::PIInstruction> const & instructions = isa.getInstructions();
+        for(uint32_t value = 0; value < table.size(); value += 1) {
+            lc3::core::IInstruction const * inst = nullptr;
+            // Earlier instructions take precedence, e.g. TRAP x25 decodes as TRAP rather than HALT.
+            for(uint32_t i = 0; i < patterns.size(); i += 1) {
+                if((value & patterns[i].first) == patterns[i].second) {
+                    inst = instructions[i].get();
+                    break;
                 }
-                return inst;
             }
+            table[value] = decodeValue(inst, static_cast<uint16_t>(value));
         }
+
+        return table;
     }
+}
 
-    return {};
+Decoder::Decoder(void)
+{
+    static std::vector<DecodedInstruction> const shared_table = buildDecodeTable();
+    table = shared_table.data();
 }
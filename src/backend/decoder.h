@@ -13,15 +13,21 @@ namespace core
 {
 namespace sim
 {
-    class Decoder : public lc3::core::ISAHandler
+    class Decoder
     {
     public:
         Decoder(void);
 
-        optional<PIInstruction> decode(uint16_t value) const;
+        // Returns nullptr if the value is not a legal instruction.
+        DecodedInstruction const * decode(uint16_t value) const
+        {
+            DecodedInstruction const & entry = table[value];
+            return entry.inst != nullptr ? &entry : nullptr;
+        }
 
     private:
-        std::map<uint16_t, std::vector<PIInstruction>> instructions_by_opcode;
+        // Shared by every Decoder; indexed by the raw instruction word.
+        DecodedInstruction const * table;
     };
 };
 };
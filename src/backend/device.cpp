@@ -5,30 +5,64 @@
 
 using namespace lc3::core;
 
-std::pair<uint16_t, PIMicroOp> RWReg::read(uint16_t addr)
+namespace
 {
-    if(addr == data_addr) {
-        return std::make_pair(data.getValue(), nullptr);
-    }
+    std::pair<uint16_t, PIMicroOp> dispatchRead(IDevice * device, uint16_t addr) { return device->read(addr); }
+    PIMicroOp dispatchWrite(IDevice * device, uint16_t addr, uint16_t value) { return device->write(addr, value); }
+};
 
-    return std::make_pair(0x0000, nullptr);
+IDevice::RegHandlers IDevice::getRegHandlers(uint16_t addr) const
+{
+    (void) addr;
+    return { dispatchRead, dispatchWrite };
 }
 
-PIMicroOp RWReg::write(uint16_t addr, uint16_t value)
+std::pair<uint16_t, PIMicroOp> IDevice::ignoreRead(IDevice * device, uint16_t addr)
 {
-    if(addr == data_addr) {
-        data.setValue(value);
-    }
+    (void) device;
+    (void) addr;
+    return std::make_pair(0x0000, nullptr);
+}
 
+PIMicroOp IDevice::ignoreWrite(IDevice * device, uint16_t addr, uint16_t value)
+{
+    (void) device;
+    (void) addr;
+    (void) value;
     return nullptr;
 }
 
-std::vector<uint16_t> RWReg::getAddrMap(void) const
+void IDevice::requestTick(uint64_t delay)
+{
+    if(scheduler == nullptr) { return; }
+
+    wakeup = std::min(wakeup, scheduler->getStep() + delay);
+    scheduler->wakeAt(wakeup);
+}
+
+void IDevice::requestTickAsync(void)
+{
+    if(scheduler == nullptr) { return; }
+
+    async_wakeup.store(true, std::memory_order_release);
+    scheduler->wakeAsync();
+}
+
+bool IDevice::takeWakeup(void)
 {
-    return { data_addr };
+    bool due = async_wakeup.exchange(false, std::memory_order_acquire);
+    if(wakeup <= scheduler->getStep()) {
+        wakeup = DeviceScheduler::NEVER;
+        due = true;
+    } else if(wakeup != DeviceScheduler::NEVER) {
+        scheduler->wakeAt(wakeup);
+    }
+
+    return due;
 }
 
-KeyboardDevice::KeyboardDevice(lc3::utils::IInputter & inputter) : inputter(inputter)
+KeyboardDevice::KeyboardDevice(lc3::utils::IInputter & inputter, MicroOpArena & arena) :
+    inputter(inputter), arena(arena)
 {
     status.setValue(0x0000);
     data.setValue(0x0000);
@@ -37,47 +71,87 @@ KeyboardDevice::KeyboardDevice(lc3::utils::IInputter & inputter) : inputter(inpu
 void KeyboardDevice::startup(void)
 {
     inputter.beginInput();
+    inputter.setInputListener([this](void) { requestTickAsync(); });
 }
 
 void KeyboardDevice::shutdown(void)
 {
+    inputter.setInputListener(nullptr);
     inputter.endInput();
 }
 
 std::pair<uint16_t, PIMicroOp> KeyboardDevice::read(uint16_t addr)
+{
+    return getRegHandlers(addr).read(this, addr);
+}
+
+PIMicroOp KeyboardDevice::write(uint16_t addr, uint16_t value)
+{
+    return getRegHandlers(addr).write(this, addr, value);
+}
+
+uint16_t KeyboardDevice::peek(uint16_t addr) const
 {
     if(addr == KBSR) {
-        PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::INPUT_POLL);
-        return std::make_pair(status.getValue(), callback);
+        return status.getValue();
     } else if(addr == KBDR) {
-        uint16_t status_value = status.getValue();
-        if(utils::getBit(status_value, 15) == 1) {
-            PIMicroOp write_addr = std::make_shared<RegWriteImmMicroOp>(8, KBSR);
-            PIMicroOp toggle_status = std::make_shared<MemWriteImmMicroOp>(8, status_value & 0x7FFF);
-            PIMicroOp pop_from_buffer = std::make_shared<GenericPopMicroOp<std::queue<KeyInfo>>>(key_buffer, "kbbuf");
-            write_addr->insert(toggle_status);
-            toggle_status->insert(pop_from_buffer);
-            return std::make_pair(data.getValue(), write_addr);
-        } else {
-            PIMicroOp callback = nullptr;
-
-            if(! inputter.hasRemaining()) {
-                callback = std::make_shared<CallbackMicroOp>(CallbackType::INPUT_REQUEST);
-            }
-
-            return std::make_pair(data.getValue(), callback);
-        }
+        return data.getValue();
     }
 
-    return std::make_pair(0x0000, nullptr);
+    return 0x0000;
 }
 
-PIMicroOp KeyboardDevice::write(uint16_t addr, uint16_t value)
+IDevice::RegHandlers KeyboardDevice::getRegHandlers(uint16_t addr) const
 {
     if(addr == KBSR) {
-        status.setValue(value & 0x4000);
+        return { readStatus, writeStatus };
+    } else if(addr == KBDR) {
+        return { readData, ignoreWrite };
     }
 
+    return { ignoreRead, ignoreWrite };
+}
+
+std::pair<uint16_t, PIMicroOp> KeyboardDevice::readStatus(IDevice * device, uint16_t addr)
+{
+    (void) addr;
+    KeyboardDevice & keyboard = static_cast<KeyboardDevice &>(*device);
+    PIMicroOp callback = keyboard.arena.make<CallbackMicroOp>(CallbackType::INPUT_POLL);
+    return std::make_pair(keyboard.status.getValue(), callback);
+}
+
+std::pair<uint16_t, PIMicroOp> KeyboardDevice::readData(IDevice * device, uint16_t addr)
+{
+    (void) addr;
+    KeyboardDevice & keyboard = static_cast<KeyboardDevice &>(*device);
+    uint16_t status_value = keyboard.status.getValue();
+    if(utils::getBit(status_value, 15) == 1) {
+        PIMicroOp write_addr = keyboard.arena.make<RegWriteImmMicroOp>(8, KBSR);
+        PIMicroOp toggle_status = keyboard.arena.make<MemWriteImmMicroOp>(8, status_value & 0x7FFF);
+        PIMicroOp pop_from_buffer = keyboard.arena.make<GenericPopMicroOp<std::queue<KeyInfo>>>(keyboard.key_buffer,
+            "kbbuf");
+        write_addr->insert(toggle_status);
+        toggle_status->insert(pop_from_buffer);
+        // The next key, if any, is made ready by the next tick.
+        keyboard.requestTick();
+        return std::make_pair(keyboard.data.getValue(), write_addr);
+    } else {
+        PIMicroOp callback = nullptr;
+
+        if(! keyboard.inputter.hasRemaining()) {
+            callback = keyboard.arena.make<CallbackMicroOp>(CallbackType::INPUT_REQUEST);
+        }
+
+        return std::make_pair(keyboard.data.getValue(), callback);
+    }
+}
+
+PIMicroOp KeyboardDevice::writeStatus(IDevice * device, uint16_t addr, uint16_t value)
+{
+    (void) addr;
+    KeyboardDevice & keyboard = static_cast<KeyboardDevice &>(*device);
+    keyboard.status.setValue(value & 0x4000);
+    keyboard.requestTick();
     return nullptr;
 }
 
@@ -92,6 +166,8 @@ PIMicroOp KeyboardDevice::tick(void)
     char c;
     if(inputter.getChar(c)) {
         key_buffer.emplace(c);
+        // Characters are taken one per tick, so keep ticking until the inputter runs dry.
+        requestTick();
     }
 
     if(! key_buffer.empty()) {
@@ -100,46 +176,121 @@ PIMicroOp KeyboardDevice::tick(void)
 
         if(! key_buffer.front().triggered_interrupt && (status.getValue() & 0x4000) == 0x4000) {
             key_buffer.front().triggered_interrupt = true;
-            return std::make_shared<PushInterruptTypeMicroOp>(InterruptType::KEYBOARD);
+            return arena.make<PushInterruptTypeMicroOp>(InterruptType::KEYBOARD);
         }
     }
 
     return nullptr;
 }
 
-std::pair<uint16_t, PIMicroOp> DisplayDevice::read(uint16_t addr)
+void KeyboardDevice::tickIdle(uint64_t count)
 {
-    if(addr == DSR) {
-        return std::make_pair(status.getValue(), nullptr);
+    // Ticks after the inputter runs dry only repeat the same status update.
+    char c;
+    uint64_t taken = 0;
+    while(taken < count && inputter.getChar(c)) {
+        key_buffer.emplace(c);
+        taken += 1;
+    }
+    if(taken == count && count != 0) {
+        requestTick();
     }
 
-    return std::make_pair(0x0000, nullptr);
+    if(count != 0 && ! key_buffer.empty()) {
+        status.setValue(status.getValue() | 0x8000);
+        data.setValue(static_cast<uint16_t>(key_buffer.front().value));
+    }
+}
+
+PIDeviceState KeyboardDevice::saveState(void) const
+{
+    std::shared_ptr<SavedState> saved = std::make_shared<SavedState>();
+    saved->status = status.getValue();
+    saved->data = data.getValue();
+    saved->key_buffer = key_buffer;
+    return saved;
+}
+
+void KeyboardDevice::restoreState(PIDeviceState const & state)
+{
+    SavedState const & saved = static_cast<SavedState const &>(*state);
+    status.setValue(saved.status);
+    data.setValue(saved.data);
+    key_buffer = saved.key_buffer;
 }
 
 DisplayDevice::DisplayDevice(lc3::utils::Logger & logger) : logger(logger)
 {
     status.setValue(0x0000);
     data.setValue(0x0000);
+    output.reserve(FLUSH_SIZE);
+}
+
+std::pair<uint16_t, PIMicroOp> DisplayDevice::read(uint16_t addr)
+{
+    return getRegHandlers(addr).read(this, addr);
 }
 
 PIMicroOp DisplayDevice::write(uint16_t addr, uint16_t value)
+{
+    return getRegHandlers(addr).write(this, addr, value);
+}
+
+uint16_t DisplayDevice::peek(uint16_t addr) const
+{
+    // DDR reads as 0, like any other register the display doesn't let be read.
+    return addr == DSR ? status.getValue() : 0x0000;
+}
+
+IDevice::RegHandlers DisplayDevice::getRegHandlers(uint16_t addr) const
 {
     if(addr == DSR) {
-        status.setValue(value & 0x4000);
+        return { readStatus, writeStatus };
     } else if(addr == DDR) {
-        // Clear ready bit.
-        status.setValue(status.getValue() & 0x7FFF);
-
-        // Write to DDR and output to screen.
-        data.setValue(value & 0x00FF);
-        char char_value = static_cast<char>(value & 0x00FF);
-        if(char_value == 10 || char_value == 13) {
-            logger.newline(utils::PrintType::P_NONE);
-        } else {
-            logger.print(std::string(1, char_value));
+        return { ignoreRead, writeData };
+    }
+
+    return { ignoreRead, ignoreWrite };
+}
+
+std::pair<uint16_t, PIMicroOp> DisplayDevice::readStatus(IDevice * device, uint16_t addr)
+{
+    (void) addr;
+    return std::make_pair(static_cast<DisplayDevice &>(*device).status.getValue(), nullptr);
+}
+
+PIMicroOp DisplayDevice::writeStatus(IDevice * device, uint16_t addr, uint16_t value)
+{
+    (void) addr;
+    DisplayDevice & display = static_cast<DisplayDevice &>(*device);
+    display.status.setValue(value & 0x4000);
+    display.requestTick();
+    return nullptr;
+}
+
+PIMicroOp DisplayDevice::writeData(IDevice * device, uint16_t addr, uint16_t value)
+{
+    (void) addr;
+    DisplayDevice & display = static_cast<DisplayDevice &>(*device);
+
+    // Clear ready bit.
+    display.status.setValue(display.status.getValue() & 0x7FFF);
+
+    // Write to DDR and output to screen.
+    display.data.setValue(value & 0x00FF);
+    char char_value = static_cast<char>(value & 0x00FF);
+    if(char_value == 10 || char_value == 13) {
+        display.flush();
+        display.logger.newline(utils::PrintType::P_NONE);
+    } else {
+        display.output.push_back(char_value);
+        if(display.output.size() >= FLUSH_SIZE) {
+            display.flush();
         }
     }
 
+    // The ready bit is set again by the next tick.
+    display.requestTick();
     return nullptr;
 }
 
@@ -148,6 +299,14 @@ std::vector<uint16_t> DisplayDevice::getAddrMap(void) const
     return { DSR, DDR };
 }
 
+void DisplayDevice::flush(void)
+{
+    if(! output.empty()) {
+        logger.print(output.data(), output.size());
+        output.clear();
+    }
+}
+
 PIMicroOp DisplayDevice::tick(void)
 {
     // Set ready bit.
@@ -155,3 +314,25 @@ PIMicroOp DisplayDevice::tick(void)
 
     return nullptr;
 }
+
+void DisplayDevice::tickIdle(uint64_t count)
+{
+    if(count != 0) {
+        tick();
+    }
+}
+
+PIDeviceState DisplayDevice::saveState(void) const
+{
+    std::shared_ptr<SavedState> saved = std::make_shared<SavedState>();
+    saved->status = status.getValue();
+    saved->data = data.getValue();
+    return saved;
+}
+
+void DisplayDevice::restoreState(PIDeviceState const & state)
+{
+    SavedState const & saved = static_cast<SavedState const &>(*state);
+    status.setValue(saved.status);
+    data.setValue(saved.data);
+}
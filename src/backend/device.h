@@ -4,6 +4,9 @@
 #ifndef DEVICE_H
 #define DEVICE_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <queue>
@@ -19,53 +22,125 @@ namespace lc3
 {
 namespace core
 {
+    // Counts instruction steps and keeps the earliest step on which a device asked to be ticked, so that devices
+    // with nothing to do aren't visited at all.
+    class DeviceScheduler
+    {
+    public:
+        static constexpr uint64_t NEVER = UINT64_MAX;
+
+        DeviceScheduler(void) : step(0), next_wakeup(NEVER), async_wakeup(false) { }
+
+        uint64_t getStep(void) const { return step; }
+        void setStep(uint64_t step) { this->step = step; }
+        // Earliest step a device has asked for, or the current one if a device was woken from another thread.
+        uint64_t getNextWakeup(void) const
+        {
+            return async_wakeup.load(std::memory_order_relaxed) ? std::min(next_wakeup, step) : next_wakeup;
+        }
+        void wakeAt(uint64_t wakeup) { next_wakeup = std::min(next_wakeup, wakeup); }
+        void wakeAsync(void) { async_wakeup.store(true, std::memory_order_release); }
+        // Forgets all wakeups before a pass over the devices, during which they register the ones still pending.
+        void beginPass(void)
+        {
+            next_wakeup = NEVER;
+            async_wakeup.store(false, std::memory_order_relaxed);
+        }
+
+    private:
+        uint64_t step;
+        uint64_t next_wakeup;
+        std::atomic<bool> async_wakeup;
+    };
+
+    // What a device saves in a machine snapshot, so that it can carry on from there when the snapshot is restored.
+    class IDeviceState
+    {
+    public:
+        virtual ~IDeviceState(void) = default;
+    };
+    using PIDeviceState = std::shared_ptr<IDeviceState const>;
+
     class IDevice
     {
     public:
-        IDevice(void) = default;
+        IDevice(void) : scheduler(nullptr), wakeup(DeviceScheduler::NEVER), async_wakeup(false) { }
         virtual ~IDevice(void) {}
 
         virtual void startup(void) { }
         virtual void shutdown(void) { }
         virtual std::pair<uint16_t, PIMicroOp> read(uint16_t addr) = 0;
         virtual PIMicroOp write(uint16_t addr, uint16_t value) = 0;
+        // The value a read of the register would return, without any of the read's effects, for showing the register
+        // from outside of a run, possibly while one is going.  Devices that don't override it show 0.
+        virtual uint16_t peek(uint16_t addr) const { (void) addr; return 0x0000; }
         virtual std::vector<uint16_t> getAddrMap(void) const = 0;
         virtual std::string getName(void) const = 0;
         virtual PIMicroOp tick(void) { return nullptr; }
-    };
-
-    class RWReg : public IDevice
-    {
-    public:
-        RWReg(uint16_t data_addr) : data_addr(data_addr) { data.setValue(0x0000); }
-        virtual ~RWReg(void) override = default;
-
-        virtual std::pair<uint16_t, PIMicroOp> read(uint16_t addr) override;
-        virtual PIMicroOp write(uint16_t addr, uint16_t value) override;
-        virtual std::vector<uint16_t> getAddrMap(void) const override;
-        virtual std::string getName(void) const override { return "RWReg"; }
+        virtual bool canInterrupt(void) const { return false; }
+        // Equivalent to count ticks with nothing accessing the device in between.  Only valid while the device can't
+        // interrupt, so there are no micro-ops to return.
+        virtual void tickIdle(uint64_t count) { for(uint64_t i = 0; i < count; i += 1) { tick(); } }
+        // Polled devices are ticked before every instruction.  The others are only ticked on the steps they asked for
+        // with requestTick, so they must ask whenever a tick would change something.
+        virtual bool isPolled(void) const { return true; }
+        // Devices without registers or buffers of their own have nothing to save.
+        virtual PIDeviceState saveState(void) const { return nullptr; }
+        virtual void restoreState(PIDeviceState const & state) { (void) state; }
+
+        // Handlers for accesses to one of the device's registers, which the machine state calls without going
+        // through read and write.
+        struct RegHandlers
+        {
+            std::pair<uint16_t, PIMicroOp> (*read)(IDevice * device, uint16_t addr);
+            PIMicroOp (*write)(IDevice * device, uint16_t addr, uint16_t value);
+        };
+        // By default, a register's accesses go through read and write.
+        virtual RegHandlers getRegHandlers(uint16_t addr) const;
+
+        void attachScheduler(DeviceScheduler & scheduler) { this->scheduler = &scheduler; }
+        // Asks for a tick delay instruction steps from now, where 1 is before the next instruction.
+        void requestTick(uint64_t delay = 1);
+        // Asks for a tick before the next instruction.  May be called from any thread.
+        void requestTickAsync(void);
+        // Returns whether the device is due on the current step, and if so clears its wakeup.  Any later wakeup is
+        // registered with the scheduler again.
+        bool takeWakeup(void);
+
+        // Handlers for registers, or parts of them, that ignore accesses.
+        static std::pair<uint16_t, PIMicroOp> ignoreRead(IDevice * device, uint16_t addr);
+        static PIMicroOp ignoreWrite(IDevice * device, uint16_t addr, uint16_t value);
 
     private:
-        MemLocation data;
-        uint16_t data_addr;
+        DeviceScheduler * scheduler;
+        uint64_t wakeup;
+        std::atomic<bool> async_wakeup;
     };
 
     class KeyboardDevice : public IDevice
     {
     public:
-        KeyboardDevice(lc3::utils::IInputter & inputter);
+        KeyboardDevice(lc3::utils::IInputter & inputter, MicroOpArena & arena);
         virtual ~KeyboardDevice(void) override = default;
 
         virtual void startup(void) override;
         virtual void shutdown(void) override;
         virtual std::pair<uint16_t, PIMicroOp> read(uint16_t addr) override;
         virtual PIMicroOp write(uint16_t addr, uint16_t value) override;
+        virtual uint16_t peek(uint16_t addr) const override;
         virtual std::vector<uint16_t> getAddrMap(void) const override;
         virtual std::string getName(void) const override { return "Keyboard"; }
         virtual PIMicroOp tick(void) override;
+        virtual bool canInterrupt(void) const override { return (status.getValue() & 0x4000) != 0; }
+        virtual void tickIdle(uint64_t count) override;
+        virtual bool isPolled(void) const override { return inputter.isPolled(); }
+        virtual PIDeviceState saveState(void) const override;
+        virtual void restoreState(PIDeviceState const & state) override;
+        virtual RegHandlers getRegHandlers(uint16_t addr) const override;
 
     private:
         lc3::utils::IInputter & inputter;
+        MicroOpArena & arena;
 
         MemLocation status;
         MemLocation data;
@@ -80,6 +155,16 @@ namespace core
         };
 
         std::queue<KeyInfo> key_buffer;
+
+        struct SavedState : public IDeviceState
+        {
+            uint16_t status, data;
+            std::queue<KeyInfo> key_buffer;
+        };
+
+        static std::pair<uint16_t, PIMicroOp> readStatus(IDevice * device, uint16_t addr);
+        static std::pair<uint16_t, PIMicroOp> readData(IDevice * device, uint16_t addr);
+        static PIMicroOp writeStatus(IDevice * device, uint16_t addr, uint16_t value);
     };
 
     class DisplayDevice : public IDevice
@@ -90,15 +175,38 @@ namespace core
 
         virtual std::pair<uint16_t, PIMicroOp> read(uint16_t addr) override;
         virtual PIMicroOp write(uint16_t addr, uint16_t value) override;
+        virtual uint16_t peek(uint16_t addr) const override;
         virtual std::vector<uint16_t> getAddrMap(void) const override;
         virtual std::string getName(void) const override { return "Display"; }
         virtual PIMicroOp tick(void) override;
+        virtual void tickIdle(uint64_t count) override;
+        virtual bool isPolled(void) const override { return false; }
+        virtual void shutdown(void) override { flush(); }
+        virtual PIDeviceState saveState(void) const override;
+        virtual void restoreState(PIDeviceState const & state) override;
+        virtual RegHandlers getRegHandlers(uint16_t addr) const override;
+
+        // Characters written to DDR are collected and printed together at a newline, once there are FLUSH_SIZE of
+        // them, or when flushed, which the simulator does before anything else could see or print output.
+        void flush(void);
 
     private:
+        static constexpr size_t FLUSH_SIZE = 256;
+
         lc3::utils::Logger & logger;
 
         MemLocation status;
         MemLocation data;
+        std::string output;
+
+        struct SavedState : public IDeviceState
+        {
+            uint16_t status, data;
+        };
+
+        static std::pair<uint16_t, PIMicroOp> readStatus(IDevice * device, uint16_t addr);
+        static PIMicroOp writeStatus(IDevice * device, uint16_t addr, uint16_t value);
+        static PIMicroOp writeData(IDevice * device, uint16_t addr, uint16_t value);
     };
 };
 };
@@ -11,12 +11,8 @@
 using namespace lc3::core::asmbl;
 
 Encoder::Encoder(lc3::utils::AssemblerLogger & logger, bool enable_liberal_asm)
-    : ISAHandler(), logger(logger), enable_liberal_asm(enable_liberal_asm)
-{
-    for(PIInstruction inst : instructions) {
-        instructions_by_name[inst->getName()].push_back(inst);
-    }
-}
+    : isa(ISAHandler::get()), logger(logger), enable_liberal_asm(enable_liberal_asm)
+{ }
 
 bool Encoder::isStringPseudo(std::string const & search) const
 {
@@ -41,6 +37,7 @@ bool Encoder::isStringValidReg(std::string const & search) const
       // reg string may also contain a comma left by the tokenizer
       std::string lower_search_comma = search.substr(0, search.size() - 1);
       std::transform(lower_search_comma.begin(), lower_search_comma.end(), lower_search_comma.begin(), ::tolower);
+      SymbolTable const & regs = isa.getRegs();
       return regs.find(lower_search) != regs.end() || regs.find(lower_search_comma) != regs.end();
     } catch (std::exception & e) { // defensive catch in case anything with search goes wrong
         return false;
@@ -49,7 +46,7 @@ bool Encoder::isStringValidReg(std::string const & search) const
 
 bool Encoder::isStringInstructionName(std::string const & name) const
 {
-    return instructions_by_name.count(utils::toLower(name));
+    return isa.getInstructionsByName().count(utils::toLower(name));
 }
 
 bool Encoder::isValidAlphaNumLabel(Statement const & statement) const
@@ -258,7 +255,7 @@ lc3::optional<lc3::core::PIInstruction> Encoder::validateInstruction(Statement c
     bool name_match = false;
     PIInstruction match = nullptr;
 
-    for(auto const & candidate_inst_name : instructions_by_name) {
+    for(auto const & candidate_inst_name : isa.getInstructionsByName()) {
         name_match = utils::toLower(statement.base->str) == candidate_inst_name.first;
         if(name_match) {
             for(PIInstruction candidate_inst : candidate_inst_name.second) {
@@ -398,7 +395,8 @@ lc3::optional<uint32_t> Encoder::encodeInstruction(Statement const & statement,
     lc3::core::PIInstruction pattern) const
 {
     // The first "operand" of an instruction encoding is the op-code.
-    optional<uint32_t> inst_encoding = pattern->getOperand(0)->encode(statement, *statement.base, regs, symbols, logger);
+    optional<uint32_t> inst_encoding = pattern->getOperand(0)->encode(statement, *statement.base, isa.getRegs(),
+        symbols, logger);
     uint32_t encoding;
     if(inst_encoding) {
         encoding = *inst_encoding;
@@ -416,9 +414,10 @@ lc3::optional<uint32_t> Encoder::encodeInstruction(Statement const & statement,
             optional<uint32_t> operand_encoding = {};
             if(operand->getType() == IOperand::Type::FIXED) {
                 StatementPiece dummy;
-                operand_encoding = operand->encode(statement, dummy, regs, symbols, logger);
+                operand_encoding = operand->encode(statement, dummy, isa.getRegs(), symbols, logger);
             } else {
-                operand_encoding = operand->encode(statement, statement.operands[operand_idx], regs, symbols, logger);
+                operand_encoding = operand->encode(statement, statement.operands[operand_idx], isa.getRegs(), symbols,
+                    logger);
             }
 
             if(operand_encoding) {
@@ -16,7 +16,7 @@ namespace core
 {
 namespace asmbl
 {
-    class Encoder : public ISAHandler
+    class Encoder
     {
     public:
         Encoder(lc3::utils::AssemblerLogger & logger, bool enable_liberal_assembly);
@@ -49,13 +49,12 @@ namespace asmbl
         void setLiberalAsm(bool enable_liberal_asm) { this->enable_liberal_asm = enable_liberal_asm; }
 
     private:
+        ISAHandler const & isa;
         lc3::utils::AssemblerLogger & logger;
         bool enable_liberal_asm;
 
         bool validatePseudoOperands(Statement const & statement, std::string const & pseudo,
             std::vector<StatementPiece::Type> const & valid_types, uint32_t operand_count, bool log_enable) const;
-
-        std::map<std::string, std::vector<PIInstruction>> instructions_by_name;
     };
 };
 };
@@ -11,11 +11,11 @@ using namespace lc3::core;
 
 void AtomicInstProcessEvent::handleEvent(MachineState & state)
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    PIMicroOp fetch = std::make_shared<FetchMicroOp>();
-    PIMicroOp inc_pc = std::make_shared<PCAddImmMicroOp>(1);
-    PIMicroOp decode = std::make_shared<DecodeMicroOp>(decoder);
+    PIMicroOp fetch = arena.make<FetchMicroOp>();
+    PIMicroOp inc_pc = arena.make<PCAddImmMicroOp>(1);
+    PIMicroOp decode = arena.make<DecodeMicroOp>(decoder);
 
     fetch->insert(inc_pc);
     inc_pc->insert(decode);
@@ -163,8 +163,10 @@ void LoadObjFileEvent::handleEvent(MachineState & state)
             fill_pc = mem.getValue();
             offset = 0;
         } else {
-            logger.printf(lc3::utils::PrintType::P_DEBUG, true, "0x%0.4x: %s (0x%0.4x)", fill_pc + offset,
-                mem.getLine().c_str(), mem.getValue());
+            logger.printfLazy(lc3::utils::PrintType::P_DEBUG, true, [&](void) {
+                return lc3::utils::ssprintf("0x%0.4x: %s (0x%0.4x)", fill_pc + offset, mem.getLine().c_str(),
+                    mem.getValue());
+            });
             state.writeMem(fill_pc + offset, mem.getValue());
             state.setMemLine(fill_pc + offset, mem.getLine());
             offset += 1;
@@ -196,16 +198,19 @@ std::string DeviceUpdateEvent::toString(MachineState const & state) const
 
 void CheckForInterruptEvent::handleEvent(MachineState & state)
 {
+    MicroOpArena & arena = state.getMicroOpArena();
+    // Handling an interrupt changes the priority level, which asks for another check.
+    state.completeInterruptCheck();
+
     InterruptType interrupt = state.peekInterrupt();
     if(interrupt != InterruptType::INVALID &&
         (getInterruptPriority(interrupt) > lc3::utils::getBits(state.readPSR(), 10, 8)))
     {
         std::pair<PIMicroOp, PIMicroOp> handle_interrupt_chain = buildSystemModeEnter(INTEX_TABLE_START,
-            getInterruptVector(interrupt), getInterruptPriority(interrupt)
-        );
-        PIMicroOp dequeue_interrupt = std::make_shared<PopInterruptTypeMicroOp>();
-        PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::INT_ENTER);
-        PIMicroOp func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::INTERRUPT);
+            getInterruptVector(interrupt), getInterruptPriority(interrupt), state);
+        PIMicroOp dequeue_interrupt = arena.make<PopInterruptTypeMicroOp>();
+        PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::INT_ENTER);
+        PIMicroOp func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::INTERRUPT);
 
         handle_interrupt_chain.second->insert(dequeue_interrupt);
         dequeue_interrupt->insert(callback);
@@ -229,7 +234,7 @@ std::string CheckForInterruptEvent::toString(MachineState const & state) const
 
 void CallbackEvent::handleEvent(MachineState & state)
 {
-    func(type, state);
+    func(sim, type, state);
 }
 
 std::string CallbackEvent::toString(MachineState const & state) const
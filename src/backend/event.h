@@ -18,16 +18,19 @@ namespace lc3
 namespace core
 {
     class MachineState;
+    class Simulator;
 
     class IEvent
     {
     public:
         uint64_t time;
         PIMicroOp uops;
+        // Intrusive link used by the EventQueue the event is scheduled on.
+        IEvent * next;
 
         IEvent(void) : IEvent(0) { }
         IEvent(uint64_t time) : IEvent(time, nullptr) { }
-        IEvent(uint64_t time, PIMicroOp uops) : time(time), uops(uops) { }
+        IEvent(uint64_t time, PIMicroOp uops) : time(time), uops(uops), next(nullptr) { }
         virtual ~IEvent(void) = default;
 
         virtual void handleEvent(MachineState & state) = 0;
@@ -116,15 +119,17 @@ namespace core
     class CallbackEvent : public IEvent
     {
     public:
-        using Callback = std::function<void(CallbackType, MachineState &)>;
+        using Callback = void (*)(Simulator * sim, CallbackType type, MachineState & state);
 
-        CallbackEvent(uint64_t time, CallbackType type, Callback func) : IEvent(time), type(type), func(func) { }
+        CallbackEvent(uint64_t time, CallbackType type, Simulator * sim, Callback func) :
+            IEvent(time), type(type), sim(sim), func(func) { }
 
         virtual void handleEvent(MachineState & state) override;
         virtual std::string toString(MachineState const & state) const override;
 
     private:
         CallbackType type;
+        Simulator * sim;
         Callback func;
     };
 };
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include "event_queue.h"
+
+using namespace lc3::core::sim;
+
+static uint64_t countTrailingZeros(uint64_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(value);
+#else
+    uint64_t count = 0;
+    while((value & 1) == 0) {
+        value >>= 1;
+        count += 1;
+    }
+    return count;
+#endif
+}
+
+EventQueue::EventQueue(void) : occupied(0), overflow(nullptr), late(nullptr), now(0), wheel_count(0), size(0)
+{
+    for(Slot & slot : wheel) {
+        slot.head = nullptr;
+        slot.tail = nullptr;
+    }
+}
+
+EventQueue::~EventQueue(void)
+{
+    clear();
+}
+
+void EventQueue::push(PIEvent event)
+{
+    IEvent * node = event.release();
+    node->next = nullptr;
+    size += 1;
+
+    if(node->time < now) {
+        insertSorted(late, node);
+    } else if(node->time - now < WHEEL_SIZE) {
+        append(node);
+    } else {
+        insertSorted(overflow, node);
+    }
+}
+
+lc3::core::PIEvent EventQueue::pop(void)
+{
+    if(size == 0) { return nullptr; }
+
+    IEvent * node;
+    if(late != nullptr) {
+        node = late;
+        late = node->next;
+    } else {
+        if(wheel_count == 0) {
+            // Nothing is due within the wheel's span, so jump straight to the next overflow event.
+            now = overflow->time;
+            migrateOverflow();
+        }
+        uint64_t index = now & WHEEL_MASK;
+        if(wheel[index].head == nullptr) {
+            // Skip ahead to the next occupied slot.  Overflow events are all due after the end of the wheel, so none of
+            // them can come first.
+            uint64_t rotated = (occupied >> index) | (occupied << ((WHEEL_SIZE - index) & WHEEL_MASK));
+            now += countTrailingZeros(rotated);
+            index = now & WHEEL_MASK;
+            migrateOverflow();
+        }
+
+        Slot & slot = wheel[index];
+        node = slot.head;
+        slot.head = node->next;
+        if(slot.head == nullptr) {
+            slot.tail = nullptr;
+            occupied &= ~(static_cast<uint64_t>(1) << index);
+        }
+        wheel_count -= 1;
+    }
+
+    size -= 1;
+    node->next = nullptr;
+    return PIEvent(node);
+}
+
+void EventQueue::clear(void)
+{
+    for(Slot & slot : wheel) {
+        destroyList(slot.head);
+        slot.head = nullptr;
+        slot.tail = nullptr;
+    }
+    occupied = 0;
+    destroyList(overflow);
+    destroyList(late);
+    overflow = nullptr;
+    late = nullptr;
+    wheel_count = 0;
+    size = 0;
+}
+
+void EventQueue::append(IEvent * event)
+{
+    uint64_t index = event->time & WHEEL_MASK;
+    Slot & slot = wheel[index];
+    if(slot.tail == nullptr) {
+        slot.head = event;
+    } else {
+        slot.tail->next = event;
+    }
+    slot.tail = event;
+    occupied |= static_cast<uint64_t>(1) << index;
+    wheel_count += 1;
+}
+
+void EventQueue::insertSorted(IEvent *& list, IEvent * event)
+{
+    // Insert after any events due at the same time, so that they keep the order they were scheduled in.
+    IEvent ** link = &list;
+    while(*link != nullptr && (*link)->time <= event->time) {
+        link = &(*link)->next;
+    }
+    event->next = *link;
+    *link = event;
+}
+
+void EventQueue::migrateOverflow(void)
+{
+    while(overflow != nullptr && overflow->time - now < WHEEL_SIZE) {
+        IEvent * node = overflow;
+        overflow = node->next;
+        node->next = nullptr;
+        append(node);
+    }
+}
+
+void EventQueue::destroyList(IEvent * list)
+{
+    while(list != nullptr) {
+        IEvent * next = list->next;
+        delete list;
+        list = next;
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "event.h"
+
+namespace lc3
+{
+namespace core
+{
+namespace sim
+{
+    // Timing wheel of pending events, keyed on IEvent::time.  Events are linked through IEvent::next, so scheduling
+    // and dispatching one never allocates.  Events due at the same time are dispatched in the order they were
+    // scheduled.
+    //
+    // The wheel covers the WHEEL_SIZE ticks starting at the time of the last dispatched event, which is where nearly
+    // every event lands.  Events further out wait in a sorted overflow list and move onto the wheel as time catches up
+    // with them.  Events scheduled in the past are dispatched first, earliest first.
+    class EventQueue
+    {
+    public:
+        EventQueue(void);
+        ~EventQueue(void);
+        EventQueue(EventQueue const &) = delete;
+        EventQueue & operator=(EventQueue const &) = delete;
+
+        template<typename T, typename ... Args>
+        void emplace(Args && ... args) { push(PIEvent(new T(std::forward<Args>(args)...))); }
+        void push(PIEvent event);
+        // Removes and returns the earliest event, or nullptr if the queue is empty.
+        PIEvent pop(void);
+        bool empty(void) const { return size == 0; }
+        // Destroys all pending events.  An event that has already been popped is owned by the caller and unaffected.
+        void clear(void);
+
+    private:
+        static constexpr uint64_t WHEEL_SIZE = 64;
+        static constexpr uint64_t WHEEL_MASK = WHEEL_SIZE - 1;
+
+        struct Slot
+        {
+            IEvent * head;
+            IEvent * tail;
+        };
+
+        Slot wheel[WHEEL_SIZE];
+        // Bit i is set when wheel[i] is non-empty, so that empty slots can be skipped in one step.
+        uint64_t occupied;
+        IEvent * overflow;
+        IEvent * late;
+        uint64_t now;
+        size_t wheel_count;
+        size_t size;
+
+        void append(IEvent * event);
+        void insertSorted(IEvent *& list, IEvent * event);
+        void migrateOverflow(void);
+        static void destroyList(IEvent * list);
+    };
+};
+};
+};
+
+#endif
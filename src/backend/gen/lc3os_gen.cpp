@@ -0,0 +1,135 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "assembler.h"
+#include "lc3os.h"
+#include "mem.h"
+#include "printer.h"
+#include "utils.h"
+
+// Assembles the OS source in lc3os.cpp and writes it out as C++ that defines lc3::core::getOSImage, so that the
+// library does not have to assemble the OS every time a simulator is created.
+
+class StderrPrinter : public lc3::utils::IPrinter
+{
+public:
+    virtual void setColor(lc3::utils::PrintColor color) override { (void) color; }
+    virtual void print(std::string const & string) override { std::cerr << string; }
+    virtual void newline(void) override { std::cerr << "\n"; }
+};
+
+struct Block
+{
+    uint16_t start;
+    std::vector<lc3::core::MemLocation> locations;
+};
+
+static std::string quote(std::string const & str)
+{
+    std::string quoted = "\"";
+    for(char c : str) {
+        unsigned char const u = static_cast<unsigned char>(c);
+        if(c == '"' || c == '\\' || c == '?') {
+            // Question marks are escaped so that no trigraphs are formed.
+            quoted += '\\';
+            quoted += c;
+        } else if(u < 0x20 || u >= 0x7F) {
+            char escaped[5];
+            std::snprintf(escaped, sizeof(escaped), "\\%03o", u);
+            quoted += escaped;
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+int main(int argc, char * argv[])
+{
+    if(argc != 2) {
+        std::cerr << "usage: " << argv[0] << " output.cpp\n";
+        return 1;
+    }
+
+    StderrPrinter printer;
+    lc3::core::Assembler assembler(printer, static_cast<uint32_t>(lc3::utils::PrintType::P_ERROR), false);
+    assembler.setFilename("lc3os");
+
+    std::stringstream src_buffer;
+    src_buffer << lc3::core::getOSSrc();
+    std::pair<std::shared_ptr<std::stringstream>, lc3::core::SymbolTable> asm_res;
+    try {
+        asm_res = assembler.assemble(src_buffer);
+    } catch(lc3::utils::exception const & e) {
+        std::cerr << "could not assemble the OS: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::istream & obj = *asm_res.first;
+    obj.ignore(lc3::utils::getMagicHeader().size() + lc3::utils::getVersionString().size());
+    std::vector<Block> blocks;
+    while(true) {
+        lc3::core::MemLocation mem;
+        obj >> mem;
+        if(obj.eof()) { break; }
+
+        if(mem.isOrig()) {
+            blocks.push_back(Block{mem.getValue(), {}});
+        } else if(! blocks.empty()) {
+            blocks.back().locations.push_back(mem);
+        }
+    }
+
+    // An .ORIG that is immediately followed by another one fills nothing.
+    for(size_t i = blocks.size(); i > 0; i -= 1) {
+        if(blocks[i - 1].locations.empty()) {
+            blocks.erase(blocks.begin() + (i - 1));
+        }
+    }
+
+    std::ofstream out(argv[1]);
+    out << "// Generated by lc3os_gen from the source in lc3os.cpp.  Do not edit.\n";
+    out << "#include \"lc3os.h\"\n\n";
+    out << "namespace\n{\n";
+    for(size_t i = 0; i < blocks.size(); i += 1) {
+        out << "    uint16_t const values_" << i << "[] = {\n";
+        for(lc3::core::MemLocation const & mem : blocks[i].locations) {
+            out << lc3::utils::ssprintf("        0x%04x,\n", mem.getValue());
+        }
+        out << "    };\n";
+        out << "    char const * const lines_" << i << "[] = {\n";
+        for(lc3::core::MemLocation const & mem : blocks[i].locations) {
+            out << "        " << quote(mem.getLine()) << ",\n";
+        }
+        out << "    };\n";
+    }
+    out << "    lc3::core::OSImage::Block const blocks[] = {\n";
+    for(size_t i = 0; i < blocks.size(); i += 1) {
+        out << lc3::utils::ssprintf("        { 0x%04x, %u, values_%u, lines_%u },\n", blocks[i].start,
+            static_cast<uint32_t>(blocks[i].locations.size()), static_cast<uint32_t>(i), static_cast<uint32_t>(i));
+    }
+    out << "    };\n";
+    out << "    lc3::core::OSImage::Symbol const symbols[] = {\n";
+    for(auto const & symbol : asm_res.second) {
+        out << "        { " << quote(symbol.first) << lc3::utils::ssprintf(", 0x%04x },\n", symbol.second);
+    }
+    out << "    };\n";
+    out << "};\n\n";
+    out << "lc3::core::OSImage const & lc3::core::getOSImage(void)\n{\n";
+    out << "    static OSImage const image = { blocks, " << blocks.size() << ", symbols, " << asm_res.second.size()
+        << " };\n";
+    out << "    return image;\n}\n";
+
+    if(! out) {
+        std::cerr << "could not write " << argv[1] << "\n";
+        return 1;
+    }
+    return 0;
+}
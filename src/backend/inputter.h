@@ -4,6 +4,8 @@
 #ifndef INPUTTER_H
 #define INPUTTER_H
 
+#include <functional>
+
 namespace lc3
 {
 namespace utils
@@ -18,6 +20,10 @@ namespace utils
         virtual bool getChar(char & c) = 0;
         virtual void endInput(void) = 0;
         virtual bool hasRemaining(void) const = 0;
+        // Polled inputters have getChar called before every instruction.  The others report new input by calling the
+        // listener, possibly from another thread, and are only asked for characters after that.
+        virtual bool isPolled(void) const { return true; }
+        virtual void setInputListener(std::function<void(void)> listener) { (void) listener; }
     };
 
     class NullInputter : public IInputter
@@ -27,6 +33,7 @@ namespace utils
         virtual bool getChar(char &) override { return false; }
         virtual void endInput(void) override {}
         virtual bool hasRemaining(void) const override { return false; }
+        virtual bool isPolled(void) const override { return false; }
     };
 };
 };
@@ -13,28 +13,21 @@
 #include "lc3os.h"
 
 lc3::sim::sim(lc3::utils::IPrinter & printer, lc3::utils::IInputter & inputter, uint32_t print_level) :
-    printer(printer), inputter(inputter), simulator(printer, inputter, print_level)
+    printer(printer), inputter(inputter), simulator(printer, inputter, print_level),
+    callback_dispatcher(std::bind(callbackDispatcher, this, std::placeholders::_1, std::placeholders::_2))
 {
     loadOS();
 
-    auto callback_dispatcher = std::bind(callbackDispatcher, this, std::placeholders::_1, std::placeholders::_2);
-    simulator.registerCallback(core::CallbackType::PRE_INST, callback_dispatcher);
-    simulator.registerCallback(core::CallbackType::POST_INST, callback_dispatcher);
-    simulator.registerCallback(core::CallbackType::SUB_ENTER, callback_dispatcher);
-    simulator.registerCallback(core::CallbackType::SUB_EXIT, callback_dispatcher);
+    // Exceptions are always listened to, to tell whether a run raised one.  Any other callback is only dispatched
+    // while one is registered for it.
     simulator.registerCallback(core::CallbackType::EX_ENTER, callback_dispatcher);
-    simulator.registerCallback(core::CallbackType::EX_EXIT, callback_dispatcher);
-    simulator.registerCallback(core::CallbackType::INT_ENTER, callback_dispatcher);
-    simulator.registerCallback(core::CallbackType::INT_EXIT, callback_dispatcher);
-    simulator.registerCallback(core::CallbackType::BREAKPOINT, callback_dispatcher);
-    simulator.registerCallback(core::CallbackType::INPUT_REQUEST, callback_dispatcher);
-    simulator.registerCallback(core::CallbackType::INPUT_POLL, callback_dispatcher);
 
     total_inst_exec = 0;
     cur_inst_exec_limit = 0;
     target_inst_exec = 0;
     cur_sub_depth = 0;
     relative_inst_exec_limit = false;
+    in_run = false;
 }
 
 std::pair<bool, std::string> lc3::sim::loadObjFile(std::string const & filename)
@@ -100,6 +93,15 @@ uint64_t lc3::sim::randomizeState(uint64_t seed)
     return seed;
 }
 
+lc3::core::PMachineSnapshot lc3::sim::snapshot(void) const { return simulator.snapshot(); }
+
+void lc3::sim::restore(lc3::core::PMachineSnapshot const & snapshot)
+{
+    if(snapshot != nullptr) {
+        simulator.restore(*snapshot);
+    }
+}
+
 void lc3::sim::setRunInstLimit(uint64_t inst_limit) { cur_inst_exec_limit = inst_limit; }
 
 void lc3::sim::setRunInstLimitRelativeMode(bool is_relative) { relative_inst_exec_limit = is_relative; }
@@ -173,7 +175,18 @@ lc3::core::MachineState & lc3::sim::getMachineState(void) { return simulator.get
 lc3::core::MachineState const & lc3::sim::getMachineState(void) const { return simulator.getMachineState(); }
 
 uint16_t lc3::sim::readReg(uint16_t id) const { return simulator.getMachineState().readReg(id); }
-uint16_t lc3::sim::readMem(uint16_t addr) const { return simulator.getMachineState().readMem(addr).first; }
+uint16_t lc3::sim::readMem(uint16_t addr) const
+{
+    // Device registers are peeked at, so reading one, say from a callback, neither has side effects nor builds
+    // micro-ops that would be left for the arena to free.
+    uint16_t value = 0;
+    simulator.getMachineState().readMemRange(addr, &value, 1);
+    return value;
+}
+void lc3::sim::readMemRange(uint16_t start, uint16_t * values, uint32_t count) const
+{
+    simulator.getMachineState().readMemRange(start, values, count);
+}
 std::string lc3::sim::getMemLine(uint16_t addr) const { return simulator.getMachineState().getMemLine(addr); }
 uint16_t lc3::sim::readPC(void) const { return simulator.getMachineState().readPC(); }
 uint16_t lc3::sim::readPSR(void) const { return simulator.getMachineState().readPSR(); }
@@ -209,11 +222,44 @@ void lc3::sim::writeCC(char value)
 }
 
 void lc3::sim::setBreakpoint(uint16_t addr) { simulator.addBreakpoint(addr); }
+void lc3::sim::setBreakpoint(uint16_t addr, core::BreakCondition const & condition, uint64_t ignore_count)
+{ simulator.addBreakpoint(addr, condition, ignore_count); }
 void lc3::sim::removeBreakpoint(uint16_t addr) { simulator.removeBreakpoint(addr); }
+uint64_t lc3::sim::getBreakpointHitCount(uint16_t addr) const
+{
+    core::Breakpoint const * breakpoint = simulator.getBreakpoint(addr);
+    return breakpoint != nullptr ? breakpoint->hit_count : 0;
+}
+uint32_t lc3::sim::setWatchpoint(uint16_t start, uint16_t end, core::WatchType type,
+    core::BreakCondition const & condition, uint64_t ignore_count)
+{ return simulator.addWatchpoint(start, end, type, condition, ignore_count); }
+void lc3::sim::removeWatchpoint(uint32_t id) { simulator.removeWatchpoint(id); }
+uint64_t lc3::sim::getWatchpointHitCount(uint32_t id) const
+{
+    core::Watchpoint const * watchpoint = simulator.getWatchpoint(id);
+    return watchpoint != nullptr ? watchpoint->hit_count : 0;
+}
+lc3::core::BreakHit const & lc3::sim::getLastBreak(void) const { return simulator.getLastBreak(); }
+
+bool lc3::sim::didExceedInstLimit(void) const { return getInstExecCount() >= target_inst_exec; }
 
-bool lc3::sim::didExceedInstLimit(void) const { return total_inst_exec >= target_inst_exec; }
+void lc3::sim::registerCallback(lc3::core::CallbackType type, lc3::sim::Callback func)
+{
+    callbacks.set(type, func);
+    if(type != core::CallbackType::EX_ENTER) {
+        simulator.registerCallback(type, func != nullptr ? callback_dispatcher : nullptr);
+    }
+}
 
-void lc3::sim::registerCallback(lc3::core::CallbackType type, lc3::sim::Callback func) { callbacks[type] = func; }
+void lc3::sim::setProgressListener(lc3::sim::ProgressListener listener, uint64_t inst_interval)
+{
+    if(listener == nullptr) {
+        simulator.setProgressListener(nullptr, 0);
+        return;
+    }
+
+    simulator.setProgressListener([this, listener](core::MachineState const &) { listener(*this); }, inst_interval);
+}
 
 lc3::utils::IPrinter & lc3::sim::getPrinter(void) { return printer; }
 lc3::utils::IPrinter const & lc3::sim::getPrinter(void) const { return printer; }
@@ -221,27 +267,17 @@ lc3::utils::IInputter & lc3::sim::getInputter(void) { return inputter; }
 lc3::utils::IInputter const & lc3::sim::getInputter(void) const { return inputter; }
 void lc3::sim::setPrintLevel(uint32_t print_level) { simulator.setPrintLevel(print_level); }
 void lc3::sim::setIgnorePrivilege(bool ignore_privilege) { simulator.setIgnorePrivilege(ignore_privilege); }
+void lc3::sim::setEngine(core::EngineType engine) { simulator.setEngine(engine); }
 
-uint64_t lc3::sim::getInstExecCount(void) const { return total_inst_exec; }
+uint64_t lc3::sim::getInstExecCount(void) const
+{
+    return total_inst_exec + (in_run ? simulator.getInstExecCount() : 0);
+}
 
 void lc3::sim::loadOS(void)
 {
-    core::Assembler assembler(printer, 0, false);
-    assembler.setFilename("lc3os");
-
-    std::stringstream src_buffer;
-    src_buffer << lc3::core::getOSSrc();
-    std::pair<std::shared_ptr<std::stringstream>, core::SymbolTable> asm_res;
-    try {
-        asm_res = assembler.assemble(src_buffer);
-    } catch(utils::exception const & e) {
-#ifdef _ENABLE_DEBUG
-        printer.print("caught exception: " + std::string(e.what()));
-        printer.newline();
-#endif
-        return;
-    }
-    simulator.loadObj("lc3os", *(asm_res.first));
+    // The OS is assembled when the library is built, so loading it only copies memory.
+    simulator.loadImage(core::getOSMemImage());
 }
 
 bool lc3::sim::runHelper(void)
@@ -249,19 +285,35 @@ bool lc3::sim::runHelper(void)
     encountered_lc3_exception = false;
     target_inst_exec = (relative_inst_exec_limit ? total_inst_exec : 0) + cur_inst_exec_limit;
 
+    core::RunLimits limits;
+    limits.stop_on_halt = run_type == RunType::UNTIL_HALT;
+    limits.stop_on_input_request = run_type == RunType::UNTIL_INPUT_REQUESTED;
+    if(cur_inst_exec_limit != 0) {
+        // A target that has already been reached still lets one instruction run.
+        limits.inst_limit = target_inst_exec > total_inst_exec ? target_inst_exec - total_inst_exec : 1;
+    }
+    limits.stop_at_depth = run_type == RunType::UNTIL_DEPTH;
+    limits.start_depth = cur_sub_depth;
+    simulator.setRunLimits(limits);
+
 #ifdef _ENABLE_DEBUG
     auto start = std::chrono::high_resolution_clock::now();
 #endif
 
+    in_run = true;
     try {
         simulator.simulate();
     } catch(utils::exception const & e) {
+        total_inst_exec += simulator.getInstExecCount();
+        in_run = false;
 #ifdef _ENABLE_DEBUG
         printer.print("caught exception: " + std::string(e.what()));
         printer.newline();
 #endif
         return false;
     }
+    total_inst_exec += simulator.getInstExecCount();
+    in_run = false;
 
 #ifdef _ENABLE_DEBUG
     auto end = std::chrono::high_resolution_clock::now();
@@ -277,57 +329,16 @@ bool lc3::sim::runHelper(void)
 
 void lc3::sim::callbackDispatcher(lc3::sim * sim_inst, lc3::core::CallbackType type, lc3::core::MachineState & state)
 {
-    using namespace lc3::core;
-
-    if(type == CallbackType::PRE_INST) {
-        if(sim_inst->run_type == RunType::UNTIL_HALT && state.readMem(state.readPC()).first == 0xf025) {
-            // Halt if current instruction is HALT.
-            sim_inst->simulator.triggerSuspend();
-        }
-    } else if(type == CallbackType::POST_INST) {
-        // Increment total instruction count
-        ++(sim_inst->total_inst_exec);
-        if(sim_inst->cur_inst_exec_limit != 0) {
-            if(sim_inst->didExceedInstLimit()) {
-                // If an instruction limit is set (i.e. cur_inst_exec_limit != 0), halt when target is reached.
-                sim_inst->simulator.triggerSuspend();
-            }
-        }
+    (void) state;
 
-        if(sim_inst->run_type == RunType::UNTIL_DEPTH) {
-            if(sim_inst->cur_sub_depth == 0) {
-                sim_inst->simulator.triggerSuspend();
-            }
-        }
-    } else if(type == CallbackType::SUB_ENTER) {
-        ++(sim_inst->cur_sub_depth);
-    } else if(type == CallbackType::SUB_EXIT) {
-        if(sim_inst->cur_sub_depth > 0) {
-            --(sim_inst->cur_sub_depth);
-        }
-    } else if(type == CallbackType::EX_ENTER) {
+    // Stopping conditions are checked by the core simulator itself (see runHelper).
+    if(type == core::CallbackType::EX_ENTER) {
         // Mark that execution resulted in LC-3 exception.
         sim_inst->encountered_lc3_exception = true;
-        ++(sim_inst->cur_sub_depth);
-    } else if(type == CallbackType::EX_EXIT) {
-        if(sim_inst->cur_sub_depth > 0) {
-            --(sim_inst->cur_sub_depth);
-        }
-    } else if(type == CallbackType::INT_ENTER) {
-        ++(sim_inst->cur_sub_depth);
-    } else if(type == CallbackType::INT_EXIT) {
-        if(sim_inst->cur_sub_depth > 0) {
-            --(sim_inst->cur_sub_depth);
-        }
-    } else if(type == CallbackType::INPUT_REQUEST) {
-        if(sim_inst->run_type == RunType::UNTIL_INPUT_REQUESTED) {
-            sim_inst->simulator.triggerSuspend();
-        }
     }
 
-    auto search = sim_inst->callbacks.find(type);
-    if(search != sim_inst->callbacks.end() && search->second != nullptr) {
-        search->second(type, *sim_inst);
+    if(sim_inst->callbacks.has(type)) {
+        sim_inst->callbacks.get(type)(type, *sim_inst);
     }
 }
 
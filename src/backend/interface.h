@@ -26,6 +26,7 @@ namespace lc3
     {
     public:
         using Callback = std::function<void(core::CallbackType, sim &)>;
+        using ProgressListener = std::function<void(sim &)>;
 
         sim(utils::IPrinter & printer, utils::IInputter & inputter, uint32_t print_level);
 
@@ -33,6 +34,12 @@ namespace lc3
         void setup(void);
         void zeroState(void);
         uint64_t randomizeState(uint64_t seed = 0);
+        // A snapshot holds the memory, registers, devices, and subroutine trace, and can be restored into this or any
+        // other simulator, e.g. to reset to a freshly loaded program.  It shares memory with the simulator until
+        // either writes to it, so taking and restoring one is cheap.  Breakpoints, callbacks, settings, and the
+        // instruction count are not part of it.
+        core::PMachineSnapshot snapshot(void) const;
+        void restore(core::PMachineSnapshot const & snapshot);
 
         void setRunInstLimit(uint64_t inst_limit);
         void setRunInstLimitRelativeMode(bool is_relative);
@@ -46,6 +53,7 @@ namespace lc3
 
         uint16_t readReg(uint16_t id) const;
         uint16_t readMem(uint16_t addr) const;
+        void readMemRange(uint16_t start, uint16_t * values, uint32_t count) const;
         std::string getMemLine(uint16_t addr) const;
         uint16_t readPC(void) const;
         uint16_t readPSR(void) const;
@@ -61,11 +69,24 @@ namespace lc3
         void writeCC(char value);
 
         void setBreakpoint(uint16_t addr);
+        // Stops only when the condition holds, and not until it has held ignore_count times.
+        void setBreakpoint(uint16_t addr, core::BreakCondition const & condition, uint64_t ignore_count = 0);
         void removeBreakpoint(uint16_t addr);
+        uint64_t getBreakpointHitCount(uint16_t addr) const;
+        // Returns an ID for removeWatchpoint.  A watchpoint stops the run after the instruction that triggered it and
+        // dispatches the breakpoint callback; getLastBreak tells it apart from a breakpoint.
+        uint32_t setWatchpoint(uint16_t start, uint16_t end, core::WatchType type,
+            core::BreakCondition const & condition = core::BreakCondition(), uint64_t ignore_count = 0);
+        void removeWatchpoint(uint32_t id);
+        uint64_t getWatchpointHitCount(uint32_t id) const;
+        core::BreakHit const & getLastBreak(void) const;
 
         bool didExceedInstLimit(void) const;
 
         void registerCallback(core::CallbackType type, Callback func);
+        // Called on the running thread every inst_interval instructions of a run, e.g. to show how a long run is going.
+        // Registers, memory, and getInstExecCount may be read from it.  Pass nullptr to stop.
+        void setProgressListener(ProgressListener listener, uint64_t inst_interval);
 
         utils::IPrinter & getPrinter(void);
         utils::IPrinter const & getPrinter(void) const;
@@ -73,6 +94,7 @@ namespace lc3
         utils::IInputter const & getInputter(void) const;
         void setPrintLevel(uint32_t print_level);
         void setIgnorePrivilege(bool ignore_privilege);
+        void setEngine(core::EngineType engine);
 
         uint64_t getInstExecCount(void) const;
 
@@ -149,8 +171,11 @@ namespace lc3
         uint64_t total_inst_exec;
         uint64_t cur_inst_exec_limit, target_inst_exec;
         uint64_t cur_sub_depth;
+        // Set while a run is in progress, during which the core simulator counts its instructions.
+        bool in_run;
 
-        std::unordered_map<core::CallbackType, Callback> callbacks;
+        core::CallbackRegistry<Callback> callbacks;
+        core::Simulator::Callback callback_dispatcher;
 
         void loadOS(void);
         bool runHelper(void);
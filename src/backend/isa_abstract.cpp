@@ -57,7 +57,7 @@ std::string IInstruction::toFormatString(void) const
     return assembly.str();
 }
 
-std::string IInstruction::toValueString(void) const
+std::string IInstruction::toValueString(uint16_t value) const
 {
     std::stringstream assembly;
     assembly << name;
@@ -65,7 +65,10 @@ std::string IInstruction::toValueString(void) const
         assembly << " ";
     }
     std::string prefix = "";
+    uint32_t bit_pos = 15;
     for(PIOperand operand : operands) {
+        uint16_t operand_value = lc3::utils::getBits(value, bit_pos, bit_pos - operand->getWidth() + 1);
+        bit_pos -= operand->getWidth();
         if(operand->getType() != IOperand::Type::FIXED) {
             std::string oper_str;
             if(operand->getType() == IOperand::Type::NUM || operand->getType() == IOperand::Type::LABEL) {
@@ -74,13 +77,13 @@ std::string IInstruction::toValueString(void) const
                     operand->getType() == IOperand::Type::LABEL)
                 {
                     oper_str = "#" + std::to_string(static_cast<uint16_t>(
-                        lc3::utils::sextTo32(operand->getValue(), operand->getWidth())
+                        lc3::utils::sextTo32(operand_value, operand->getWidth())
                     ));
                 } else {
-                    oper_str = "#" + std::to_string(operand->getValue());
+                    oper_str = "#" + std::to_string(operand_value);
                 }
             } else if(operand->getType() == IOperand::Type::REG) {
-                oper_str = "r" + std::to_string(operand->getValue());
+                oper_str = "r" + std::to_string(operand_value);
             }
             assembly << prefix << oper_str;
             prefix = ", ";
@@ -90,7 +93,7 @@ std::string IInstruction::toValueString(void) const
 }
 
 lc3::optional<uint32_t> FixedOperand::encode(asmbl::Statement const & statement, asmbl::StatementPiece const & piece,
-    SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger)
+    SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger) const
 {
     (void) statement;
     (void) piece;
@@ -102,7 +105,7 @@ lc3::optional<uint32_t> FixedOperand::encode(asmbl::Statement const & statement,
 }
 
 lc3::optional<uint32_t> RegOperand::encode(asmbl::Statement const & statement, asmbl::StatementPiece const & piece,
-    SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger)
+    SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger) const
 {
     using namespace lc3::utils;
 
@@ -111,13 +114,15 @@ lc3::optional<uint32_t> RegOperand::encode(asmbl::Statement const & statement, a
 
     uint32_t token_val = regs.at(toLower(piece.str)) & ((1 << width) - 1);
 
-    logger.printf(PrintType::P_EXTRA, true, "  reg %s := %s", piece.str.c_str(), udecToBin(token_val, width).c_str());
+    logger.printfLazy(PrintType::P_EXTRA, true, [&](void) {
+        return ssprintf("  reg %s := %s", piece.str.c_str(), udecToBin(token_val, width).c_str());
+    });
 
     return token_val;
 }
 
 lc3::optional<uint32_t> NumOperand::encode(asmbl::Statement const & statement, asmbl::StatementPiece const & piece,
-    SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger)
+    SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger) const
 {
     using namespace lc3::utils;
 
@@ -130,13 +135,15 @@ lc3::optional<uint32_t> NumOperand::encode(asmbl::Statement const & statement, a
         throw lc3::utils::exception("invalid immediate");
     }
 
-    logger.printf(PrintType::P_EXTRA, true, "  imm %d := %s", piece.num, udecToBin(*ret, width).c_str());
+    logger.printfLazy(PrintType::P_EXTRA, true, [&](void) {
+        return ssprintf("  imm %d := %s", piece.num, udecToBin(*ret, width).c_str());
+    });
 
     return *ret;
 }
 
 lc3::optional<uint32_t> LabelOperand::encode(asmbl::Statement const & statement, asmbl::StatementPiece const & piece,
-    SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger)
+    SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger) const
 {
     using namespace lc3::utils;
     using namespace asmbl;
@@ -161,8 +168,10 @@ lc3::optional<uint32_t> LabelOperand::encode(asmbl::Statement const & statement,
             throw lc3::utils::exception("label too far");
         }
 
-        logger.printf(PrintType::P_EXTRA, true, "  label %s (0x%0.4x) := %s", piece.str.c_str(), search->second,
-            udecToBin(*ret, width).c_str());
+        logger.printfLazy(PrintType::P_EXTRA, true, [&](void) {
+            return ssprintf("  label %s (0x%0.4x) := %s", piece.str.c_str(), search->second,
+                udecToBin(*ret, width).c_str());
+        });
 
         return *ret;
     }
@@ -15,16 +15,24 @@ namespace lc3
 {
 namespace core
 {
+    // The ISA never changes once it is built, so a single instance is shared by every Encoder and Decoder.
     class ISAHandler
     {
     public:
-        ISAHandler(void);
-        virtual ~ISAHandler(void) = default;
+        static ISAHandler const & get(void);
 
-        SymbolTable const & getRegs(void) { return regs; }
+        SymbolTable const & getRegs(void) const { return regs; }
+        std::vector<PIInstruction> const & getInstructions(void) const { return instructions; }
+        std::map<std::string, std::vector<PIInstruction>> const & getInstructionsByName(void) const
+        {
+            return instructions_by_name;
+        }
+
+    private:
+        ISAHandler(void);
 
-    protected:
         std::vector<PIInstruction> instructions;
+        std::map<std::string, std::vector<PIInstruction>> instructions_by_name;
         SymbolTable regs;
     };
 
@@ -43,14 +51,13 @@ namespace core
         virtual ~IOperand(void) = default;
 
         virtual optional<uint32_t> encode(asmbl::Statement const & statement, asmbl::StatementPiece const & piece,
-            SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger) = 0;
+            SymbolTable const & regs, SymbolTable const & symbols, lc3::utils::AssemblerLogger & logger) const = 0;
         bool isEqualType(Type other) const;
 
         Type getType(void) const { return type; }
         std::string const & getTypeString(void) const { return type_str; }
         uint32_t getWidth(void) const { return width; }
         uint16_t getValue(void) const { return value; }
-        void setValue(uint16_t new_value) { value = new_value; }
 
     protected:
         Type type;
@@ -59,7 +66,7 @@ namespace core
         std::string type_str;
         uint32_t width;
 
-        // Used by simulator.
+        // Used by simulator to match fixed operands.
         uint16_t value;
     };
 
@@ -70,9 +77,9 @@ namespace core
         IInstruction(IInstruction const & that);
         virtual ~IInstruction(void) = default;
 
-        virtual PIMicroOp buildMicroOps(MachineState const & state) const = 0;
+        virtual PIMicroOp buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const = 0;
         std::string toFormatString(void) const;
-        std::string toValueString(void) const;
+        std::string toValueString(uint16_t value) const;
 
         std::string const & getName(void) const { return name; }
         std::vector<PIOperand> const & getOperands(void) const { return operands; }
@@ -83,12 +90,32 @@ namespace core
         std::vector<PIOperand> operands;
     };
 
+    // Immutable result of decoding a single instruction word. Every field of the LC-3 encoding is extracted (and
+    // sign-extended where the ISA calls for it) when the decode table is built, whether or not the matched
+    // instruction uses it, so results can be shared freely between simulator instances.
+    struct DecodedInstruction
+    {
+        IInstruction const * inst;
+        uint16_t value;
+        uint8_t opcode;
+        uint8_t dr;             // IR[11:9], also SR for stores and nzp for branches
+        uint8_t sr1;            // IR[8:6], also BaseR
+        uint8_t sr2;            // IR[2:0]
+        bool imm_mode;          // IR[5]
+        bool pc_relative;       // IR[11]
+        uint8_t trapvect8;
+        uint16_t imm5;
+        uint16_t offset6;
+        uint16_t pcoffset9;
+        uint16_t pcoffset11;
+    };
+
     class FixedOperand : public IOperand
     {
     public:
         FixedOperand(uint32_t width, uint32_t value);
         virtual optional<uint32_t> encode(asmbl::Statement const & statement, asmbl::StatementPiece const & piece,
-            SymbolTable const & regs, SymbolTable const & symbols, utils::AssemblerLogger & logger) override;
+            SymbolTable const & regs, SymbolTable const & symbols, utils::AssemblerLogger & logger) const override;
     };
 
     class RegOperand : public IOperand
@@ -96,7 +123,7 @@ namespace core
     public:
         RegOperand(uint32_t width);
         virtual optional<uint32_t> encode(asmbl::Statement const & statement, asmbl::StatementPiece const & piece,
-            SymbolTable const & regs, SymbolTable const & symbols, utils::AssemblerLogger & logger) override;
+            SymbolTable const & regs, SymbolTable const & symbols, utils::AssemblerLogger & logger) const override;
     };
 
     class NumOperand : public IOperand
@@ -104,7 +131,7 @@ namespace core
     public:
         NumOperand(uint32_t width, bool sext);
         virtual optional<uint32_t> encode(asmbl::Statement const & statement, asmbl::StatementPiece const & piece,
-            SymbolTable const & regs, SymbolTable const & symbols, utils::AssemblerLogger & logger) override;
+            SymbolTable const & regs, SymbolTable const & symbols, utils::AssemblerLogger & logger) const override;
         bool shouldSEXT(void) const { return sext; }
 
     private:
@@ -116,7 +143,7 @@ namespace core
     public:
         LabelOperand(uint32_t width);
         virtual optional<uint32_t> encode(asmbl::Statement const & statement, asmbl::StatementPiece const & piece,
-            SymbolTable const & regs, SymbolTable const & symbols, utils::AssemblerLogger & logger) override;
+            SymbolTable const & regs, SymbolTable const & symbols, utils::AssemblerLogger & logger) const override;
     };
 };
 };
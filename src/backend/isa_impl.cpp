@@ -5,6 +5,12 @@
 
 using namespace lc3::core;
 
+ISAHandler const & ISAHandler::get(void)
+{
+    static ISAHandler const isa;
+    return isa;
+}
+
 ISAHandler::ISAHandler(void)
 {
     regs["r0"] = 0;
@@ -51,98 +57,101 @@ ISAHandler::ISAHandler(void)
     instructions.push_back(std::make_shared<INInstruction>());
     instructions.push_back(std::make_shared<PUTSPInstruction>());
     instructions.push_back(std::make_shared<HALTInstruction>());
+
+    for(PIInstruction inst : instructions) {
+        instructions_by_name[inst->getName()].push_back(inst);
+    }
 }
 
-PIMicroOp ADDRegInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp ADDRegInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t dst_id = getOperand(1)->getValue();
-    PIMicroOp compute = std::make_shared<RegAddRegMicroOp>(dst_id, getOperand(2)->getValue(),
-        getOperand(4)->getValue());
-    PIMicroOp set_cc = std::make_shared<CCUpdateRegMicroOp>(dst_id);
+    uint16_t dst_id = decoded.dr;
+    PIMicroOp compute = arena.make<RegAddRegMicroOp>(dst_id, decoded.sr1,
+        decoded.sr2);
+    PIMicroOp set_cc = arena.make<CCUpdateRegMicroOp>(dst_id);
 
     compute->insert(set_cc);
     return compute;
 }
 
-PIMicroOp ADDImmInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp ADDImmInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t dst_id = getOperand(1)->getValue();
-    PIMicroOp compute = std::make_shared<RegAddImmMicroOp>(dst_id, getOperand(2)->getValue(),
-        lc3::utils::sextTo16(getOperand(4)->getValue(), getOperand(4)->getWidth()));
-    PIMicroOp set_cc = std::make_shared<CCUpdateRegMicroOp>(dst_id);
+    uint16_t dst_id = decoded.dr;
+    PIMicroOp compute = arena.make<RegAddImmMicroOp>(dst_id, decoded.sr1,
+        decoded.imm5);
+    PIMicroOp set_cc = arena.make<CCUpdateRegMicroOp>(dst_id);
 
     compute->insert(set_cc);
     return compute;
 }
 
-PIMicroOp ANDRegInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp ANDRegInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t dst_id = getOperand(1)->getValue();
-    PIMicroOp compute = std::make_shared<RegAndRegMicroOp>(dst_id, getOperand(2)->getValue(),
-        getOperand(4)->getValue());
-    PIMicroOp set_cc =std::make_shared<CCUpdateRegMicroOp>(dst_id);
+    uint16_t dst_id = decoded.dr;
+    PIMicroOp compute = arena.make<RegAndRegMicroOp>(dst_id, decoded.sr1,
+        decoded.sr2);
+    PIMicroOp set_cc =arena.make<CCUpdateRegMicroOp>(dst_id);
 
     compute->insert(set_cc);
     return compute;
 }
 
-PIMicroOp ANDImmInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp ANDImmInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t dst_id = getOperand(1)->getValue();
-    PIMicroOp compute = std::make_shared<RegAndImmMicroOp>(dst_id, getOperand(2)->getValue(),
-        lc3::utils::sextTo16(getOperand(4)->getValue(), getOperand(4)->getWidth()));
-    PIMicroOp set_cc = std::make_shared<CCUpdateRegMicroOp>(dst_id);
+    uint16_t dst_id = decoded.dr;
+    PIMicroOp compute = arena.make<RegAndImmMicroOp>(dst_id, decoded.sr1,
+        decoded.imm5);
+    PIMicroOp set_cc = arena.make<CCUpdateRegMicroOp>(dst_id);
 
     compute->insert(set_cc);
     return compute;
 }
 
-PIMicroOp BRInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp BRInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    PIMicroOp jump = std::make_shared<PCAddImmMicroOp>(lc3::utils::sextTo16(getOperand(2)->getValue(),
-        getOperand(2)->getWidth()));
+    uint8_t nzp = decoded.dr;
+    PIMicroOp jump = arena.make<PCAddImmMicroOp>(decoded.pcoffset9);
 
-    return std::make_shared<BranchMicroOp>([this](MachineState const & state) {
-        return (getOperand(1)->getValue() & lc3::utils::getBits(state.readPSR(), 2, 0)) != 0;
+    return arena.make<BranchMicroOp>([nzp](MachineState const & state) {
+        return (nzp & state.readCC()) != 0;
     }, "(N&n) | (Z&z) | (P&p)", jump, nullptr);
 }
 
-PIMicroOp JMPInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp JMPInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t reg_id = getOperand(2)->getValue();
-    PIMicroOp jump = std::make_shared<PCWriteRegMicroOp>(reg_id);
-    PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::SUB_EXIT);
-    PIMicroOp func_trace = std::make_shared<PopFuncTypeMicroOp>();
+    uint16_t reg_id = decoded.sr1;
+    PIMicroOp jump = arena.make<PCWriteRegMicroOp>(reg_id);
+    PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::SUB_EXIT);
+    PIMicroOp func_trace = arena.make<PopFuncTypeMicroOp>();
 
-    jump->insert(std::make_shared<BranchMicroOp>([this](MachineState const & state) {
-        return (getOperand(2)->getValue() == 7 && state.peekFuncTraceType() == FuncType::SUBROUTINE);
+    jump->insert(arena.make<BranchMicroOp>([reg_id](MachineState const & state) {
+        return (reg_id == 7 && state.peekFuncTraceType() == FuncType::SUBROUTINE);
     }, "funcTrace.top() == subroutine", callback, nullptr));
     callback->insert(func_trace);
 
     return jump;
 }
 
-PIMicroOp JSRInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp JSRInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    PIMicroOp link = std::make_shared<RegWritePCMicroOp>(7);
-    PIMicroOp jump = std::make_shared<PCAddImmMicroOp>(lc3::utils::sextTo16(getOperand(2)->getValue(),
-        getOperand(2)->getWidth()));
-    PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::SUB_ENTER);
-    PIMicroOp func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::SUBROUTINE);
+    PIMicroOp link = arena.make<RegWritePCMicroOp>(7);
+    PIMicroOp jump = arena.make<PCAddImmMicroOp>(decoded.pcoffset11);
+    PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::SUB_ENTER);
+    PIMicroOp func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::SUBROUTINE);
 
     link->insert(jump);
     jump->insert(callback);
@@ -150,15 +159,15 @@ PIMicroOp JSRInstruction::buildMicroOps(MachineState const & state) const
     return link;
 }
 
-PIMicroOp JSRRInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp JSRRInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    PIMicroOp temp = std::make_shared<RegWritePCMicroOp>(8); // TEMP=PC*
-    PIMicroOp jump = std::make_shared<PCWriteRegMicroOp>(getOperand(3)->getValue()); // PC=BaseR
-    PIMicroOp link = std::make_shared<RegAddImmMicroOp>(7, 8, 0); // R7=TEMP
-    PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::SUB_ENTER);
-    PIMicroOp func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::SUBROUTINE);
+    PIMicroOp temp = arena.make<RegWritePCMicroOp>(8); // TEMP=PC*
+    PIMicroOp jump = arena.make<PCWriteRegMicroOp>(decoded.sr1); // PC=BaseR
+    PIMicroOp link = arena.make<RegAddImmMicroOp>(7, 8, 0); // R7=TEMP
+    PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::SUB_ENTER);
+    PIMicroOp func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::SUBROUTINE);
 
     temp->insert(jump);
     jump->insert(link);
@@ -167,16 +176,16 @@ PIMicroOp JSRRInstruction::buildMicroOps(MachineState const & state) const
     return temp;
 }
 
-PIMicroOp LDInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp LDInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t dst_id = getOperand(1)->getValue();
-    PIMicroOp write_pc = std::make_shared<RegWritePCMicroOp>(8);
-    PIMicroOp compute_addr = std::make_shared<RegAddImmMicroOp>(8, 8,
-        lc3::utils::sextTo16(getOperand(2)->getValue(), getOperand(2)->getWidth()));
-    PIMicroOp load = std::make_shared<MemReadMicroOp>(dst_id, 8);
-    PIMicroOp set_cc = std::make_shared<CCUpdateRegMicroOp>(dst_id);
+    uint16_t dst_id = decoded.dr;
+    PIMicroOp write_pc = arena.make<RegWritePCMicroOp>(8);
+    PIMicroOp compute_addr = arena.make<RegAddImmMicroOp>(8, 8,
+        decoded.pcoffset9);
+    PIMicroOp load = arena.make<MemReadMicroOp>(dst_id, 8);
+    PIMicroOp set_cc = arena.make<CCUpdateRegMicroOp>(dst_id);
 
     write_pc->insert(compute_addr);
     compute_addr->insert(load);
@@ -184,17 +193,17 @@ PIMicroOp LDInstruction::buildMicroOps(MachineState const & state) const
     return write_pc;
 }
 
-PIMicroOp LDIInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp LDIInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t dst_id = getOperand(1)->getValue();
-    PIMicroOp write_pc = std::make_shared<RegWritePCMicroOp>(8);
-    PIMicroOp compute_addr = std::make_shared<RegAddImmMicroOp>(8, 8,
-        lc3::utils::sextTo16(getOperand(2)->getValue(), getOperand(2)->getWidth()));
-    PIMicroOp load1 = std::make_shared<MemReadMicroOp>(8, 8);
-    PIMicroOp load2 = std::make_shared<MemReadMicroOp>(dst_id, 8);
-    PIMicroOp set_cc = std::make_shared<CCUpdateRegMicroOp>(dst_id);
+    uint16_t dst_id = decoded.dr;
+    PIMicroOp write_pc = arena.make<RegWritePCMicroOp>(8);
+    PIMicroOp compute_addr = arena.make<RegAddImmMicroOp>(8, 8,
+        decoded.pcoffset9);
+    PIMicroOp load1 = arena.make<MemReadMicroOp>(8, 8);
+    PIMicroOp load2 = arena.make<MemReadMicroOp>(dst_id, 8);
+    PIMicroOp set_cc = arena.make<CCUpdateRegMicroOp>(dst_id);
 
     write_pc->insert(compute_addr);
     compute_addr->insert(load1);
@@ -203,17 +212,17 @@ PIMicroOp LDIInstruction::buildMicroOps(MachineState const & state) const
     return write_pc;
 }
 
-PIMicroOp LDRInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp LDRInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t dst_id = getOperand(1)->getValue();
-    uint16_t base_id = getOperand(2)->getValue();
-    PIMicroOp write_base = std::make_shared<RegWriteRegMicroOp>(8, base_id);
-    PIMicroOp compute_addr = std::make_shared<RegAddImmMicroOp>(8, 8,
-        lc3::utils::sextTo16(getOperand(3)->getValue(), getOperand(3)->getWidth()));
-    PIMicroOp load = std::make_shared<MemReadMicroOp>(dst_id, 8);
-    PIMicroOp set_cc = std::make_shared<CCUpdateRegMicroOp>(dst_id);
+    uint16_t dst_id = decoded.dr;
+    uint16_t base_id = decoded.sr1;
+    PIMicroOp write_base = arena.make<RegWriteRegMicroOp>(8, base_id);
+    PIMicroOp compute_addr = arena.make<RegAddImmMicroOp>(8, 8,
+        decoded.offset6);
+    PIMicroOp load = arena.make<MemReadMicroOp>(dst_id, 8);
+    PIMicroOp set_cc = arena.make<CCUpdateRegMicroOp>(dst_id);
 
     write_base->insert(compute_addr);
     compute_addr->insert(load);
@@ -221,60 +230,64 @@ PIMicroOp LDRInstruction::buildMicroOps(MachineState const & state) const
     return write_base;
 }
 
-PIMicroOp LEAInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp LEAInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t dst_id = getOperand(1)->getValue();
-    PIMicroOp write_pc = std::make_shared<RegWritePCMicroOp>(8);
-    PIMicroOp compute_addr = std::make_shared<RegAddImmMicroOp>(dst_id, 8,
-        lc3::utils::sextTo16(getOperand(2)->getValue(), getOperand(2)->getWidth()));
+    uint16_t dst_id = decoded.dr;
+    PIMicroOp write_pc = arena.make<RegWritePCMicroOp>(8);
+    PIMicroOp compute_addr = arena.make<RegAddImmMicroOp>(dst_id, 8,
+        decoded.pcoffset9);
 
     write_pc->insert(compute_addr);
     return write_pc;
 }
 
-PIMicroOp NOTInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp NOTInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t dst_id = getOperand(1)->getValue();
-    PIMicroOp compute = std::make_shared<RegNotMicroOp>(dst_id, getOperand(2)->getValue());
-    PIMicroOp set_cc = std::make_shared<CCUpdateRegMicroOp>(dst_id);
+    uint16_t dst_id = decoded.dr;
+    PIMicroOp compute = arena.make<RegNotMicroOp>(dst_id, decoded.sr1);
+    PIMicroOp set_cc = arena.make<CCUpdateRegMicroOp>(dst_id);
 
     compute->insert(set_cc);
     return compute;
 }
 
-PIMicroOp RTIInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp RTIInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    PIMicroOp msg = std::make_shared<PrintMessageMicroOp>("privilege violation");
-    PIMicroOp dec_pc = std::make_shared<PCAddImmMicroOp>(-1);
+    (void) decoded;
+
+    MicroOpArena & arena = state.getMicroOpArena();
+
+    PIMicroOp msg = arena.make<PrintMessageMicroOp>("privilege violation");
+    PIMicroOp dec_pc = arena.make<PCAddImmMicroOp>(-1);
     std::pair<PIMicroOp, PIMicroOp> handle_exception_chain = buildSystemModeEnter(INTEX_TABLE_START, 0x0,
-        lc3::utils::getBits(state.readPSR(), 10, 8));
-    PIMicroOp ex_callback = std::make_shared<CallbackMicroOp>(CallbackType::EX_ENTER);
-    PIMicroOp ex_func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
-
-    PIMicroOp load_pc = std::make_shared<MemReadMicroOp>(8, 6);
-    PIMicroOp write_pc = std::make_shared<PCWriteRegMicroOp>(8);
-    PIMicroOp dec_sp1 = std::make_shared<RegAddImmMicroOp>(6, 6, 1);
-    PIMicroOp load_psr = std::make_shared<MemReadMicroOp>(8, 6);
-    PIMicroOp write_psr = std::make_shared<PSRWriteRegMicroOp>(8);
-    PIMicroOp dec_sp2 = std::make_shared<RegAddImmMicroOp>(6, 6, 1);
-    PIMicroOp save_cur_sp = std::make_shared<RegWriteRegMicroOp>(9, 6);
-    PIMicroOp write_ssp = std::make_shared<RegWriteSSPMicroOp>(6);
-    PIMicroOp write_cur_sp = std::make_shared<SSPWriteRegMicroOp>(9);
+        lc3::utils::getBits(state.readPSR(), 10, 8), state);
+    PIMicroOp ex_callback = arena.make<CallbackMicroOp>(CallbackType::EX_ENTER);
+    PIMicroOp ex_func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
+
+    PIMicroOp load_pc = arena.make<MemReadMicroOp>(8, 6);
+    PIMicroOp write_pc = arena.make<PCWriteRegMicroOp>(8);
+    PIMicroOp dec_sp1 = arena.make<RegAddImmMicroOp>(6, 6, 1);
+    PIMicroOp load_psr = arena.make<MemReadMicroOp>(8, 6);
+    PIMicroOp write_psr = arena.make<PSRWriteRegMicroOp>(8);
+    PIMicroOp dec_sp2 = arena.make<RegAddImmMicroOp>(6, 6, 1);
+    PIMicroOp save_cur_sp = arena.make<RegWriteRegMicroOp>(9, 6);
+    PIMicroOp write_ssp = arena.make<RegWriteSSPMicroOp>(6);
+    PIMicroOp write_cur_sp = arena.make<SSPWriteRegMicroOp>(9);
 
     PIMicroOp callback = nullptr;
     switch(state.peekFuncTraceType()) {
-        case FuncType::TRAP: callback = std::make_shared<CallbackMicroOp>(CallbackType::SUB_EXIT); break;
-        case FuncType::INTERRUPT: callback = std::make_shared<CallbackMicroOp>(CallbackType::INT_EXIT); break;
-        case FuncType::EXCEPTION: callback = std::make_shared<CallbackMicroOp>(CallbackType::EX_EXIT); break;
+        case FuncType::TRAP: callback = arena.make<CallbackMicroOp>(CallbackType::SUB_EXIT); break;
+        case FuncType::INTERRUPT: callback = arena.make<CallbackMicroOp>(CallbackType::INT_EXIT); break;
+        case FuncType::EXCEPTION: callback = arena.make<CallbackMicroOp>(CallbackType::EX_EXIT); break;
         default: break;
     }
-    PIMicroOp func_trace = std::make_shared<PopFuncTypeMicroOp>();
+    PIMicroOp func_trace = arena.make<PopFuncTypeMicroOp>();
 
-    PIMicroOp start = std::make_shared<BranchMicroOp>([](MachineState const & state) {
+    PIMicroOp start = arena.make<BranchMicroOp>([](MachineState const & state) {
         return lc3::utils::getBit(state.readPSR(), 15) == 0;
     }, "PSR[15] == 0", load_pc, msg);
 
@@ -288,7 +301,7 @@ PIMicroOp RTIInstruction::buildMicroOps(MachineState const & state) const
     dec_sp1->insert(load_psr);
     load_psr->insert(write_psr);
     write_psr->insert(dec_sp2);
-    dec_sp2->insert(std::make_shared<BranchMicroOp>([](MachineState const & state) {
+    dec_sp2->insert(arena.make<BranchMicroOp>([](MachineState const & state) {
         return lc3::utils::getBit(state.readPSR(), 15) == 0;
     }, "PSR[15] == 0", callback, save_cur_sp));
 
@@ -302,31 +315,31 @@ PIMicroOp RTIInstruction::buildMicroOps(MachineState const & state) const
     return start;
 }
 
-PIMicroOp STInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp STInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t src_id = getOperand(1)->getValue();
-    PIMicroOp write_pc = std::make_shared<RegWritePCMicroOp>(8);
-    PIMicroOp compute_addr = std::make_shared<RegAddImmMicroOp>(8, 8,
-        lc3::utils::sextTo16(getOperand(2)->getValue(), getOperand(2)->getWidth()));
-    PIMicroOp store = std::make_shared<MemWriteRegMicroOp>(8, src_id);
+    uint16_t src_id = decoded.dr;
+    PIMicroOp write_pc = arena.make<RegWritePCMicroOp>(8);
+    PIMicroOp compute_addr = arena.make<RegAddImmMicroOp>(8, 8,
+        decoded.pcoffset9);
+    PIMicroOp store = arena.make<MemWriteRegMicroOp>(8, src_id);
 
     write_pc->insert(compute_addr);
     compute_addr->insert(store);
     return write_pc;
 }
 
-PIMicroOp STIInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp STIInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t src_id = getOperand(1)->getValue();
-    PIMicroOp write_pc = std::make_shared<RegWritePCMicroOp>(8);
-    PIMicroOp compute_addr = std::make_shared<RegAddImmMicroOp>(8, 8,
-        lc3::utils::sextTo16(getOperand(2)->getValue(), getOperand(2)->getWidth()));
-    PIMicroOp load = std::make_shared<MemReadMicroOp>(8, 8);
-    PIMicroOp store = std::make_shared<MemWriteRegMicroOp>(8, src_id);
+    uint16_t src_id = decoded.dr;
+    PIMicroOp write_pc = arena.make<RegWritePCMicroOp>(8);
+    PIMicroOp compute_addr = arena.make<RegAddImmMicroOp>(8, 8,
+        decoded.pcoffset9);
+    PIMicroOp load = arena.make<MemReadMicroOp>(8, 8);
+    PIMicroOp store = arena.make<MemWriteRegMicroOp>(8, src_id);
 
     write_pc->insert(compute_addr);
     compute_addr->insert(load);
@@ -334,28 +347,30 @@ PIMicroOp STIInstruction::buildMicroOps(MachineState const & state) const
     return write_pc;
 }
 
-PIMicroOp STRInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp STRInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
-    (void) state;
+    MicroOpArena & arena = state.getMicroOpArena();
 
-    uint16_t src_id = getOperand(1)->getValue();
-    uint16_t base_id = getOperand(2)->getValue();
-    PIMicroOp write_base = std::make_shared<RegWriteRegMicroOp>(8, base_id);
-    PIMicroOp compute_addr = std::make_shared<RegAddImmMicroOp>(8, 8,
-        lc3::utils::sextTo16(getOperand(3)->getValue(), getOperand(3)->getWidth()));
-    PIMicroOp store = std::make_shared<MemWriteRegMicroOp>(8, src_id);
+    uint16_t src_id = decoded.dr;
+    uint16_t base_id = decoded.sr1;
+    PIMicroOp write_base = arena.make<RegWriteRegMicroOp>(8, base_id);
+    PIMicroOp compute_addr = arena.make<RegAddImmMicroOp>(8, 8,
+        decoded.offset6);
+    PIMicroOp store = arena.make<MemWriteRegMicroOp>(8, src_id);
 
     write_base->insert(compute_addr);
     compute_addr->insert(store);
     return write_base;
 }
 
-PIMicroOp TRAPInstruction::buildMicroOps(MachineState const & state) const
+PIMicroOp TRAPInstruction::buildMicroOps(MachineState const & state, DecodedInstruction const & decoded) const
 {
+    MicroOpArena & arena = state.getMicroOpArena();
+
     std::pair<PIMicroOp, PIMicroOp> handle_trap_chain = buildSystemModeEnter(TRAP_TABLE_START,
-        static_cast<uint8_t>(getOperand(2)->getValue()), (state.readPSR() & 0x0700) >> 8);
-    PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::SUB_ENTER);
-    PIMicroOp func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::TRAP);
+        static_cast<uint8_t>(decoded.trapvect8), (state.readPSR() & 0x0700) >> 8, state);
+    PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::SUB_ENTER);
+    PIMicroOp func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::TRAP);
 
     handle_trap_chain.second->insert(callback);
     callback->insert(func_trace);
@@ -372,29 +387,32 @@ bool lc3::core::isAccessViolation(uint16_t addr, MachineState const & state)
     }
 }
 
-std::pair<PIMicroOp, PIMicroOp> lc3::core::buildSystemModeEnter(uint16_t table_start, uint8_t vec, uint8_t priority)
+std::pair<PIMicroOp, PIMicroOp> lc3::core::buildSystemModeEnter(uint16_t table_start, uint8_t vec, uint8_t priority,
+    MachineState const & state)
 {
-    PIMicroOp save_cur_sp = std::make_shared<RegWriteRegMicroOp>(8, 6);
-    PIMicroOp write_ssp = std::make_shared<RegWriteSSPMicroOp>(6);
-    PIMicroOp write_cur_sp = std::make_shared<SSPWriteRegMicroOp>(8);
-    PIMicroOp dec_sp1 = std::make_shared<RegAddImmMicroOp>(6, 6, -1);
-    PIMicroOp write_psr = std::make_shared<RegWritePSRMicroOp>(9);
-    PIMicroOp copy_psr = std::make_shared<RegWriteRegMicroOp>(10, 9);
-    PIMicroOp clear_priority = std::make_shared<RegAndImmMicroOp>(10, 10, 0xF1FF);
-    PIMicroOp set_priority = std::make_shared<RegAddImmMicroOp>(10, 10, (priority & 0x7) << 8);
-    PIMicroOp write_priority = std::make_shared<PSRWriteRegMicroOp>(10);
-    PIMicroOp set_priv = std::make_shared<RegAndImmMicroOp>(10, 10, 0x7FFF);
-    PIMicroOp change_priv = std::make_shared<PSRWriteRegMicroOp>(10);
-    PIMicroOp store_psr = std::make_shared<MemWriteRegMicroOp>(6, 9);
-    PIMicroOp dec_sp2 = std::make_shared<RegAddImmMicroOp>(6, 6, -1);
-    PIMicroOp write_pc = std::make_shared<RegWritePCMicroOp>(9);
-    PIMicroOp store_pc = std::make_shared<MemWriteRegMicroOp>(6, 9);
-    PIMicroOp write_table_start = std::make_shared<RegWriteImmMicroOp>(11, table_start);
-    PIMicroOp add_table_offset = std::make_shared<RegAddImmMicroOp>(11, 11, vec);
-    PIMicroOp load_table = std::make_shared<MemReadMicroOp>(11, 11);
-    PIMicroOp jump = std::make_shared<PCWriteRegMicroOp>(11);
-
-    PIMicroOp start = std::make_shared<BranchMicroOp>([](MachineState const & state) {
+    MicroOpArena & arena = state.getMicroOpArena();
+
+    PIMicroOp save_cur_sp = arena.make<RegWriteRegMicroOp>(8, 6);
+    PIMicroOp write_ssp = arena.make<RegWriteSSPMicroOp>(6);
+    PIMicroOp write_cur_sp = arena.make<SSPWriteRegMicroOp>(8);
+    PIMicroOp dec_sp1 = arena.make<RegAddImmMicroOp>(6, 6, -1);
+    PIMicroOp write_psr = arena.make<RegWritePSRMicroOp>(9);
+    PIMicroOp copy_psr = arena.make<RegWriteRegMicroOp>(10, 9);
+    PIMicroOp clear_priority = arena.make<RegAndImmMicroOp>(10, 10, 0xF1FF);
+    PIMicroOp set_priority = arena.make<RegAddImmMicroOp>(10, 10, (priority & 0x7) << 8);
+    PIMicroOp write_priority = arena.make<PSRWriteRegMicroOp>(10);
+    PIMicroOp set_priv = arena.make<RegAndImmMicroOp>(10, 10, 0x7FFF);
+    PIMicroOp change_priv = arena.make<PSRWriteRegMicroOp>(10);
+    PIMicroOp store_psr = arena.make<MemWriteRegMicroOp>(6, 9);
+    PIMicroOp dec_sp2 = arena.make<RegAddImmMicroOp>(6, 6, -1);
+    PIMicroOp write_pc = arena.make<RegWritePCMicroOp>(9);
+    PIMicroOp store_pc = arena.make<MemWriteRegMicroOp>(6, 9);
+    PIMicroOp write_table_start = arena.make<RegWriteImmMicroOp>(11, table_start);
+    PIMicroOp add_table_offset = arena.make<RegAddImmMicroOp>(11, 11, vec);
+    PIMicroOp load_table = arena.make<MemReadMicroOp>(11, 11);
+    PIMicroOp jump = arena.make<PCWriteRegMicroOp>(11);
+
+    PIMicroOp start = arena.make<BranchMicroOp>([](MachineState const & state) {
         return lc3::utils::getBit(state.readPSR(), 15) == 1;
     }, "PSR[15] == 1", save_cur_sp, dec_sp1);
 
@@ -407,7 +425,7 @@ std::pair<PIMicroOp, PIMicroOp> lc3::core::buildSystemModeEnter(uint16_t table_s
     copy_psr->insert(clear_priority);
     clear_priority->insert(set_priority);
     set_priority->insert(write_priority);
-    write_priority->insert(std::make_shared<BranchMicroOp>([](MachineState const & state) {
+    write_priority->insert(arena.make<BranchMicroOp>([](MachineState const & state) {
         return lc3::utils::getBit(state.readPSR(), 15) == 1;
     }, "PSR[15] == 1", set_priv, store_psr));
 
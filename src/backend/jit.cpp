@@ -0,0 +1,485 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include "jit.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(_ENABLE_JIT) && defined(__x86_64__) && defined(__linux__)
+    #define JIT_NATIVE
+    #include <sys/mman.h>
+#endif
+
+#include "device_regs.h"
+#include "state.h"
+
+using namespace lc3::core;
+using namespace lc3::core::sim;
+
+#ifdef JIT_NATIVE
+namespace
+{
+    // Everything native code reads or writes outside of memory.  Native code keeps a pointer to it in rbx.
+    struct NativeContext
+    {
+        uint16_t regs[8];
+        uint16_t pc;
+        uint8_t cc;
+        uint8_t chain;          // set if execution may carry on in the block at pc
+        uint8_t user;           // set if system space is out of bounds
+        MachineState * state;
+        TranslatedOp const * last;
+        uint64_t count;
+        uint64_t budget;
+    };
+
+    using NativeFunction = void (*)(NativeContext * ctx);
+
+    uint8_t const CTX_PC = offsetof(NativeContext, pc);
+    uint8_t const CTX_CC = offsetof(NativeContext, cc);
+    uint8_t const CTX_CHAIN = offsetof(NativeContext, chain);
+    uint8_t const CTX_USER = offsetof(NativeContext, user);
+    uint8_t const CTX_LAST = offsetof(NativeContext, last);
+    uint8_t const CTX_COUNT = offsetof(NativeContext, count);
+    uint8_t const CTX_BUDGET = offsetof(NativeContext, budget);
+
+    // Memory is accessed through the machine state so that stores into translated code are still noticed.  A
+    // negative result means the access has to be left to the interpreter, and nothing has been changed.
+    int32_t loadWord(NativeContext * ctx, uint32_t addr)
+    {
+        if(addr >= MMIO_START || (ctx->user && addr <= SYSTEM_END)) {
+            return -1;
+        }
+        return std::get<0>(ctx->state->loadMem(static_cast<uint16_t>(addr)));
+    }
+
+    // Returns 1 if the store hit translated code, in which case nothing more can run before it is invalidated.
+    int32_t storeWord(NativeContext * ctx, uint32_t addr, uint32_t value)
+    {
+        if(addr >= MMIO_START || (ctx->user && addr <= SYSTEM_END)) {
+            return -1;
+        }
+        ctx->state->writeMem(static_cast<uint16_t>(addr), static_cast<uint16_t>(value));
+        return ctx->state->getCodeWrites().empty() ? 0 : 1;
+    }
+
+    bool isNative(DecodedInstruction const & decoded)
+    {
+        switch(decoded.opcode) {
+            case 0x0: case 0x1: case 0x2: case 0x3: case 0x5: case 0x6: case 0x7: case 0x9: case 0xa: case 0xb:
+            case 0xe:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Just enough of an x86-64 assembler for the code below.  Native code works on the context through rbx, keeps
+    // the instruction count in r12 and uses eax, ecx, edx and esi as scratch.
+    class Emitter
+    {
+    public:
+        enum Reg : uint8_t { EAX = 0, ECX = 1, EDX = 2, EBX = 3, ESI = 6, EDI = 7 };
+        enum Cond : uint8_t { JAE = 0x83, JNZ = 0x85, JS = 0x88 };
+
+        std::vector<uint8_t> code;
+
+        size_t size(void) const { return code.size(); }
+
+        void prologue(void)
+        {
+            // push rbx; push r12; push r13 (keeps the stack aligned for calls); mov rbx, rdi; mov r12, [rbx+count]
+            bytes({0x53, 0x41, 0x54, 0x41, 0x55, 0x48, 0x89, 0xFB, 0x4C, 0x8B, 0x63, CTX_COUNT});
+        }
+
+        // Leaves native code with the context describing where execution stopped.  count is the number of
+        // instructions executed since the top of the block.
+        void exit(uint16_t pc, TranslatedOp const * last, uint32_t count, bool chain)
+        {
+            // mov word [rbx+pc], pc
+            bytes({0x66, 0xC7, 0x43, CTX_PC});
+            imm16(pc);
+            if(last != nullptr) {
+                setLast(last);
+            }
+            addCount(count);
+            // mov byte [rbx+chain], chain
+            bytes({0xC6, 0x43, CTX_CHAIN, static_cast<uint8_t>(chain ? 1 : 0)});
+            // mov [rbx+count], r12; pop r13; pop r12; pop rbx; ret
+            bytes({0x4C, 0x89, 0x63, CTX_COUNT, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3});
+        }
+
+        void setLast(TranslatedOp const * last)
+        {
+            // mov rax, last; mov [rbx+last], rax
+            bytes({0x48, 0xB8});
+            imm64(reinterpret_cast<uint64_t>(last));
+            bytes({0x48, 0x89, 0x43, CTX_LAST});
+        }
+
+        void addCount(uint32_t count)
+        {
+            if(count != 0) {
+                // add r12, count
+                bytes({0x49, 0x81, 0xC4});
+                imm32(count);
+            }
+        }
+
+        // Jumps if the count is at or above the budget.
+        size_t checkBudget(void)
+        {
+            // cmp r12, [rbx+budget]
+            bytes({0x4C, 0x3B, 0x63, CTX_BUDGET});
+            return jump(JAE);
+        }
+
+        void loadReg(Reg dst, uint8_t reg) { bytes({0x0F, 0xB7, modrm(1, dst, EBX), slot(reg)}); }
+        void storeReg(uint8_t reg) { bytes({0x66, 0x89, 0x43, slot(reg)}); }
+        void storeRegImm(uint8_t reg, uint16_t value) { bytes({0x66, 0xC7, 0x43, slot(reg)}); imm16(value); }
+
+        void addImm(Reg dst, uint16_t value) { bytes({0x81, modrm(3, 0, dst)}); imm32(signExtend(value)); }
+        void andImm(Reg dst, uint16_t value) { bytes({0x81, modrm(3, 4, dst)}); imm32(signExtend(value)); }
+        void addEAXECX(void) { bytes({0x01, 0xC8}); }
+        void andEAXECX(void) { bytes({0x21, 0xC8}); }
+        void notEAX(void) { bytes({0xF7, 0xD0}); }
+        void movImm(Reg dst, uint16_t value) { code.push_back(0xB8 + dst); imm32(value); }
+        void movESIEAX(void) { bytes({0x89, 0xC6}); }
+        void truncate(Reg dst) { bytes({0x0F, 0xB7, modrm(3, dst, dst)}); }
+
+        // Sets the condition codes from ax.
+        void setCC(void)
+        {
+            // test ax, ax; setz cl; sets dl; movzx ecx, cl; movzx edx, dl
+            bytes({0x66, 0x85, 0xC0, 0x0F, 0x94, 0xC1, 0x0F, 0x98, 0xC2, 0x0F, 0xB6, 0xC9, 0x0F, 0xB6, 0xD2});
+            // cc = 1 + z + 3n: lea edx, [rdx+rdx*2]; lea ecx, [rcx+rdx+1]; mov [rbx+cc], cl
+            bytes({0x8D, 0x14, 0x52, 0x8D, 0x4C, 0x11, 0x01, 0x88, 0x4B, CTX_CC});
+        }
+
+        // Jumps if system space is out of bounds.
+        size_t testUser(void)
+        {
+            // cmp byte [rbx+user], 0
+            bytes({0x80, 0x7B, CTX_USER, 0x00});
+            return jump(JNZ);
+        }
+
+        // Jumps if any of the nzp bits are set in the condition codes.
+        size_t testCC(uint8_t nzp)
+        {
+            // test byte [rbx+cc], nzp
+            bytes({0xF6, 0x43, CTX_CC, nzp});
+            return jump(JNZ);
+        }
+
+        // Calls fn(ctx, esi, edx), leaving the result in eax.
+        void call(void * fn)
+        {
+            // mov rdi, rbx; mov rax, fn; call rax
+            bytes({0x48, 0x89, 0xDF, 0x48, 0xB8});
+            imm64(reinterpret_cast<uint64_t>(fn));
+            bytes({0xFF, 0xD0});
+        }
+
+        size_t testResult(Cond cond)
+        {
+            // test eax, eax
+            bytes({0x85, 0xC0});
+            return jump(cond);
+        }
+
+        size_t jump(Cond cond) { bytes({0x0F, cond}); imm32(0); return size() - 4; }
+        size_t jump(void) { code.push_back(0xE9); imm32(0); return size() - 4; }
+        void patch(size_t pos) { patch(pos, size()); }
+        void patch(size_t pos, size_t target)
+        {
+            uint32_t rel = static_cast<uint32_t>(static_cast<int32_t>(target) - static_cast<int32_t>(pos + 4));
+            std::memcpy(&code[pos], &rel, sizeof(rel));
+        }
+
+    private:
+        static uint8_t modrm(uint8_t mod, uint8_t reg, uint8_t rm) { return (mod << 6) | (reg << 3) | rm; }
+        static uint8_t slot(uint8_t reg) { return static_cast<uint8_t>(offsetof(NativeContext, regs) + 2 * reg); }
+        static uint32_t signExtend(uint16_t value) { return static_cast<uint32_t>(static_cast<int16_t>(value)); }
+
+        void bytes(std::initializer_list<uint8_t> values) { code.insert(code.end(), values); }
+        void imm16(uint16_t value) { bytes({static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8)}); }
+        void imm32(uint32_t value) { imm16(static_cast<uint16_t>(value)); imm16(static_cast<uint16_t>(value >> 16)); }
+        void imm64(uint64_t value) { imm32(static_cast<uint32_t>(value)); imm32(static_cast<uint32_t>(value >> 32)); }
+    };
+
+    // Leaves the address an instruction accesses in esi.
+    void emitAddress(Emitter & e, TranslatedOp const & op)
+    {
+        if(op.decoded->opcode == 0x6 || op.decoded->opcode == 0x7) {
+            e.loadReg(Emitter::ESI, op.decoded->sr1);
+            e.addImm(Emitter::ESI, op.decoded->offset6);
+            e.truncate(Emitter::ESI);
+        } else {
+            e.movImm(Emitter::ESI, op.addr);
+        }
+    }
+}
+#endif
+
+constexpr uint64_t Jit::MAX_RUN_LENGTH;
+
+Jit::Jit(void) : buffer(nullptr), buffer_used(0), seen_invalidations(0)
+{
+    stats.compilations = 0;
+    stats.flushes = 0;
+    stats.native_insts = 0;
+}
+
+Jit::~Jit(void)
+{
+#ifdef JIT_NATIVE
+    if(buffer != nullptr) {
+        munmap(buffer, BUFFER_SIZE);
+    }
+#endif
+}
+
+bool Jit::isSupported(void)
+{
+#ifdef JIT_NATIVE
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t Jit::run(BlockCache const & cache, MachineState & state, TranslatedOp const *& last, uint64_t budget)
+{
+#ifdef JIT_NATIVE
+    if(entries.empty()) {
+        entries.assign(1 << 16, nullptr);
+        heat.assign(1 << 16, 0);
+    }
+
+    // Native code is only as current as the blocks it was compiled from.
+    if(cache.getStats().invalidations != seen_invalidations) {
+        seen_invalidations = cache.getStats().invalidations;
+        flush();
+    }
+
+    TranslatedBlock const & block = *cache.getCurrentBlock();
+    if(entries[block.start] == nullptr) {
+        if(heat[block.start] == NEVER_COMPILE || ++heat[block.start] < HOT_THRESHOLD) {
+            return 0;
+        }
+
+        entries[block.start] = compile(block);
+        if(entries[block.start] == nullptr) {
+            heat[block.start] = NEVER_COMPILE;
+            return 0;
+        }
+    }
+
+    NativeContext ctx;
+    for(uint16_t i = 0; i < 8; i += 1) {
+        ctx.regs[i] = state.readReg(i);
+    }
+    ctx.cc = static_cast<uint8_t>(state.readCC());
+    ctx.user = ! state.getIgnorePrivilege() && (state.readPSR() & 0x8000) != 0;
+    ctx.state = &state;
+    ctx.count = 0;
+    ctx.budget = std::min(budget, MAX_RUN_LENGTH);
+
+    last = nullptr;
+    NativeBlock code = entries[block.start];
+    while(code != nullptr) {
+        ctx.last = nullptr;
+        reinterpret_cast<NativeFunction>(code)(&ctx);
+        if(ctx.last != nullptr) {
+            last = ctx.last;
+        }
+
+        // Fetching from the device register page, or from system space in user mode, is left to the simulator,
+        // which raises the access violation.
+        if(! ctx.chain || ctx.count >= ctx.budget || ctx.pc >= MMIO_START || (ctx.user && ctx.pc <= SYSTEM_END)) {
+            break;
+        }
+        code = entries[ctx.pc];
+    }
+
+    if(ctx.count == 0) {
+        return 0;
+    }
+
+    for(uint16_t i = 0; i < 8; i += 1) {
+        state.writeReg(i, ctx.regs[i]);
+    }
+    state.writeCC(ctx.cc);
+    state.writePC(ctx.pc);
+    stats.native_insts += ctx.count;
+    return ctx.count;
+#else
+    (void) cache;
+    (void) state;
+    (void) last;
+    (void) budget;
+    return 0;
+#endif
+}
+
+void Jit::flush(void)
+{
+    if(entries.empty()) {
+        return;
+    }
+
+    entries.assign(entries.size(), nullptr);
+    heat.assign(heat.size(), 0);
+    buffer_used = 0;
+    stats.flushes += 1;
+}
+
+Jit::NativeBlock Jit::compile(TranslatedBlock const & block)
+{
+#ifdef JIT_NATIVE
+    uint32_t count = 0;
+    while(count < block.ops.size() && isNative(*block.ops[count].decoded)) {
+        count += 1;
+    }
+    if(count == 0) {
+        return nullptr;
+    }
+    bool truncated = count < block.ops.size();
+
+    Emitter e;
+    std::vector<std::pair<size_t, uint32_t>> bail_before, bail_after;
+
+    e.prologue();
+    size_t top = e.size();
+    for(uint32_t i = 0; i < count; i += 1) {
+        TranslatedOp const & op = block.ops[i];
+        DecodedInstruction const & decoded = *op.decoded;
+        switch(decoded.opcode) {
+            case 0x1: case 0x5:
+                e.loadReg(Emitter::EAX, decoded.sr1);
+                if(decoded.imm_mode) {
+                    if(decoded.opcode == 0x1) { e.addImm(Emitter::EAX, decoded.imm5); }
+                    else { e.andImm(Emitter::EAX, decoded.imm5); }
+                } else {
+                    e.loadReg(Emitter::ECX, decoded.sr2);
+                    if(decoded.opcode == 0x1) { e.addEAXECX(); }
+                    else { e.andEAXECX(); }
+                }
+                e.storeReg(decoded.dr);
+                e.setCC();
+                break;
+            case 0x9:
+                e.loadReg(Emitter::EAX, decoded.sr1);
+                e.notEAX();
+                e.storeReg(decoded.dr);
+                e.setCC();
+                break;
+            case 0xe:
+                e.storeRegImm(decoded.dr, op.addr);
+                break;
+            case 0x2: case 0x6: case 0xa:
+                emitAddress(e, op);
+                if(decoded.opcode == 0xa) {
+                    e.call(reinterpret_cast<void *>(loadWord));
+                    bail_before.emplace_back(e.testResult(Emitter::JS), i);
+                    e.movESIEAX();
+                }
+                e.call(reinterpret_cast<void *>(loadWord));
+                bail_before.emplace_back(e.testResult(Emitter::JS), i);
+                e.storeReg(decoded.dr);
+                e.setCC();
+                break;
+            case 0x3: case 0x7: case 0xb:
+                emitAddress(e, op);
+                if(decoded.opcode == 0xb) {
+                    e.call(reinterpret_cast<void *>(loadWord));
+                    bail_before.emplace_back(e.testResult(Emitter::JS), i);
+                    e.movESIEAX();
+                }
+                e.loadReg(Emitter::EDX, decoded.dr);
+                e.call(reinterpret_cast<void *>(storeWord));
+                bail_before.emplace_back(e.testResult(Emitter::JS), i);
+                bail_after.emplace_back(e.jump(Emitter::JNZ), i);
+                break;
+            default:
+                break;
+        }
+    }
+
+    TranslatedOp const & tail = block.ops[count - 1];
+    if(tail.decoded->opcode == 0x0) {
+        uint8_t nzp = tail.decoded->dr;
+        size_t taken = nzp != 0 ? e.testCC(nzp) : 0;
+        e.exit(tail.pc + 1, &tail, count, true);
+        if(nzp != 0) {
+            e.patch(taken);
+            if(tail.addr == block.start) {
+                // Loop back without leaving native code.  The branch is the last instruction executed if the first
+                // one in the block has to be interpreted next time around.
+                e.setLast(&tail);
+                e.addCount(count);
+                size_t stop = e.checkBudget();
+                // A block in system space is left to the simulator to fetch from in user mode, as any other target.
+                size_t violation = block.start <= SYSTEM_END ? e.testUser() : 0;
+                e.patch(e.jump(), top);
+                e.patch(stop);
+                if(block.start <= SYSTEM_END) {
+                    e.patch(violation);
+                }
+                e.exit(block.start, &tail, 0, false);
+            } else {
+                e.exit(tail.addr, &tail, count, true);
+            }
+        }
+    } else if(truncated) {
+        e.exit(block.ops[count].pc, &tail, count, false);
+    } else {
+        e.exit(tail.pc + 1, &tail, count, true);
+    }
+
+    for(auto const & bail : bail_before) {
+        e.patch(bail.first);
+        e.exit(block.ops[bail.second].pc, bail.second != 0 ? &block.ops[bail.second - 1] : nullptr, bail.second,
+            false);
+    }
+    for(auto const & bail : bail_after) {
+        e.patch(bail.first);
+        e.exit(block.ops[bail.second].pc + 1, &block.ops[bail.second], bail.second + 1, false);
+    }
+
+    if(buffer == nullptr) {
+        void * mapping = mmap(nullptr, BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(mapping == MAP_FAILED) {
+            return nullptr;
+        }
+        buffer = static_cast<uint8_t *>(mapping);
+    }
+    if(e.size() > BUFFER_SIZE) {
+        return nullptr;
+    }
+    if(buffer_used + e.size() > BUFFER_SIZE) {
+        flush();
+    }
+
+    // The buffer is never writable and executable at the same time.
+    if(mprotect(buffer, BUFFER_SIZE, PROT_READ | PROT_WRITE) != 0) {
+        return nullptr;
+    }
+    uint8_t * native = buffer + buffer_used;
+    std::memcpy(native, e.code.data(), e.size());
+    buffer_used += e.size();
+    if(mprotect(buffer, BUFFER_SIZE, PROT_READ | PROT_EXEC) != 0) {
+        return nullptr;
+    }
+
+    stats.compilations += 1;
+    return native;
+#else
+    (void) block;
+    return nullptr;
+#endif
+}
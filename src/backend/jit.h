@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "translator.h"
+
+namespace lc3
+{
+namespace core
+{
+namespace sim
+{
+    struct JitStats
+    {
+        uint64_t compilations;
+        uint64_t flushes;
+        uint64_t native_insts;
+    };
+
+    // Compiles hot translated blocks to native x86-64 code.  Native code only covers instructions that touch nothing
+    // but registers and ordinary memory; it hands control back to the interpreter before a device register access,
+    // an access violation, TRAP, RTI, JSR or JMP, and right after a store into translated code.
+    class Jit
+    {
+    public:
+        Jit(void);
+        ~Jit(void);
+        Jit(Jit const &) = delete;
+        Jit & operator=(Jit const &) = delete;
+
+        static bool isSupported(void);
+
+        // Runs native code starting at the block the cache's cursor was just positioned at, following on into other
+        // compiled blocks until about budget instructions have run.  Returns the number of instructions executed and
+        // sets last to the final one, or returns 0 if the block isn't compiled (yet) or its first instruction has to be
+        // interpreted.
+        uint64_t run(BlockCache const & cache, MachineState & state, TranslatedOp const *& last, uint64_t budget);
+        void flush(void);
+
+        JitStats const & getStats(void) const { return stats; }
+
+    private:
+        using NativeBlock = void *;
+
+        static constexpr uint32_t HOT_THRESHOLD = 8;
+        static constexpr uint32_t NEVER_COMPILE = UINT32_MAX;
+        // Upper bound on the instructions run before returning to the simulator, so that it can notice a request to
+        // stop.  Checked between blocks, so it may be overshot by up to a block.
+        static constexpr uint64_t MAX_RUN_LENGTH = 1 << 16;
+        static constexpr size_t BUFFER_SIZE = 4 << 20;
+
+        uint8_t * buffer;
+        size_t buffer_used;
+        std::vector<NativeBlock> entries;
+        std::vector<uint32_t> heat;
+        uint64_t seen_invalidations;
+        JitStats stats;
+
+        NativeBlock compile(TranslatedBlock const & block);
+    };
+};
+};
+};
+
+#endif
@@ -4,13 +4,46 @@
 #ifndef LC3OS_H
 #define LC3OS_H
 
+#include <cstdint>
 #include <string>
 
+#include "aliases.h"
+
 namespace lc3
 {
 namespace core
 {
+    class MemImage;
+
     std::string getOSSrc(void);
+
+    // The OS as assembled from getOSSrc when the library is built: each block of memory it fills, with the value and
+    // source line of every location in it, and its symbols.
+    struct OSImage
+    {
+        struct Block
+        {
+            uint16_t start;
+            uint32_t size;
+            uint16_t const * values;
+            char const * const * lines;
+        };
+        struct Symbol
+        {
+            char const * name;
+            uint32_t addr;
+        };
+
+        Block const * blocks;
+        uint32_t num_blocks;
+        Symbol const * symbols;
+        uint32_t num_symbols;
+    };
+
+    OSImage const & getOSImage(void);
+    SymbolTable getOSSymbols(void);
+    // The OS image prepared to be loaded into machines, which is only done once per process.
+    MemImage const & getOSMemImage(void);
 };
 };
 
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include "lc3os.h"
+#include "state.h"
+
+// Kept apart from the OS source, which the assembler that builds getOSImage is linked with.
+
+namespace lc3
+{
+namespace core
+{
+    SymbolTable getOSSymbols(void)
+    {
+        OSImage const & image = getOSImage();
+        SymbolTable symbols;
+        for(uint32_t i = 0; i < image.num_symbols; i += 1) {
+            symbols[image.symbols[i].name] = image.symbols[i].addr;
+        }
+        return symbols;
+    }
+
+    MemImage const & getOSMemImage(void)
+    {
+        static MemImage const mem_image = [](void) {
+            OSImage const & image = getOSImage();
+            MemImage mem_image;
+            for(uint32_t i = 0; i < image.num_blocks; i += 1) {
+                OSImage::Block const & block = image.blocks[i];
+                mem_image.addBlock(block.start, block.values, block.lines, block.size);
+            }
+            return mem_image;
+        }();
+        return mem_image;
+    }
+};
+};
@@ -27,12 +27,20 @@ namespace utils
 
         template<typename ... Args>
         void printf(PrintType level, bool bold, std::string const & format, Args ... args) const;
+        // Only invokes build (a callable returning std::string) if the level is enabled, so disabled messages cost
+        // a single comparison.
+        template<typename Func>
+        void printfLazy(PrintType level, bool bold, Func const & build) const;
+        bool isEnabled(PrintType level) const { return static_cast<uint32_t>(level) <= print_level; }
         void newline(PrintType level = PrintType::P_ERROR) const {
             if(print_level > static_cast<uint32_t>(level)) { printer.newline(); }
         }
         void print(std::string const & str) {
             if(print_level > static_cast<uint32_t>(PrintType::P_NONE)) { printer.print(str); }
         }
+        void print(char const * chars, size_t count) {
+            if(print_level > static_cast<uint32_t>(PrintType::P_NONE)) { printer.printChars(chars, count); }
+        }
         uint32_t getPrintLevel(void) const { return print_level; }
         void setPrintLevel(uint32_t print_level) { this->print_level = print_level; }
     };
@@ -123,6 +131,14 @@ void lc3::utils::Logger::printf(lc3::utils::PrintType type, bool bold, std::stri
     }
 }
 
+template<typename Func>
+void lc3::utils::Logger::printfLazy(lc3::utils::PrintType type, bool bold, Func const & build) const
+{
+    if(isEnabled(type)) {
+        printf(type, bold, "%s", build().c_str());
+    }
+}
+
 template<typename ... Args>
 void lc3::utils::AssemblerLogger::asmPrintf(lc3::utils::PrintType level,
     lc3::core::asmbl::Statement const & statement, lc3::core::asmbl::StatementPiece const & piece,
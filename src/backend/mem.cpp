@@ -1,8 +1,13 @@
 /*
  * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
  */
+#include <algorithm>
 #include <cstring>
+#include <functional>
+#include <iterator>
+#include <mutex>
 #include <stdint.h>
+#include <unordered_set>
 
 #include "mem.h"
 
@@ -66,3 +71,150 @@ std::istream & lc3::core::operator>>(std::istream & in, MemLocation & out)
 
     return in;
 }
+
+lc3::core::MemLineTable::Page::Page(void) : shared(false)
+{
+    std::fill(lines, lines + PAGE_SIZE, nullptr);
+}
+
+lc3::core::MemLineTable::Page::Page(Page const & other) : shared(false)
+{
+    std::memcpy(lines, other.lines, sizeof(lines));
+    for(Line const * line : lines) {
+        hold(line);
+    }
+}
+
+lc3::core::MemLineTable::Page::~Page(void)
+{
+    for(Line const * line : lines) {
+        release(line);
+    }
+}
+
+lc3::core::MemLineTable::MemLineTable(void) : pages(1 << (16 - PAGE_BITS)) { }
+
+std::string const & lc3::core::MemLineTable::get(uint16_t addr) const
+{
+    static std::string const empty;
+
+    Page const * page = pages[addr >> PAGE_BITS].get();
+    if(page == nullptr || page->lines[addr & (PAGE_SIZE - 1)] == nullptr) {
+        return empty;
+    }
+
+    return page->lines[addr & (PAGE_SIZE - 1)]->text;
+}
+
+void lc3::core::MemLineTable::set(uint16_t addr, std::string const & line)
+{
+    std::shared_ptr<Page> & page = pages[addr >> PAGE_BITS];
+    if(page == nullptr) {
+        if(line.empty()) { return; }
+        page = std::make_shared<Page>();
+    } else if(page->shared || page.use_count() != 1) {
+        page = std::make_shared<Page>(*page);
+    }
+
+    Line const *& slot = page->lines[addr & (PAGE_SIZE - 1)];
+    release(slot);
+    slot = line.empty() ? nullptr : intern(line);
+}
+
+void lc3::core::MemLineTable::clear(void)
+{
+    for(std::shared_ptr<Page> & page : pages) {
+        page.reset();
+    }
+}
+
+void lc3::core::MemLineTable::share(void)
+{
+    // Pages still shared with a copy of the table are left as they are.
+    for(std::shared_ptr<Page> & page : pages) {
+        if(page != nullptr && ! page->shared && page.use_count() == 1) {
+            page = sharePage(page, &Page::lines);
+        }
+    }
+}
+
+void lc3::core::MemLineTable::copy(MemLineTable const & from, uint16_t start, uint32_t count)
+{
+    uint32_t const end = static_cast<uint32_t>(start) + count;
+    for(uint32_t addr = start; addr < end;) {
+        uint32_t const offset = addr & (PAGE_SIZE - 1);
+        uint32_t const num = std::min<uint32_t>(PAGE_SIZE - offset, end - addr);
+        std::shared_ptr<Page> const & from_page = from.pages[addr >> PAGE_BITS];
+        std::shared_ptr<Page> & page = pages[addr >> PAGE_BITS];
+        if(num == PAGE_SIZE || (page == nullptr && from_page == nullptr)) {
+            // A page that is copied whole is shared rather than copied.
+            page = from_page;
+        } else {
+            if(page == nullptr) {
+                page = std::make_shared<Page>();
+            } else if(page->shared || page.use_count() != 1) {
+                page = std::make_shared<Page>(*page);
+            }
+            for(uint32_t i = offset; i < offset + num; i += 1) {
+                Line const * line = from_page != nullptr ? from_page->lines[i] : nullptr;
+                hold(line);
+                release(page->lines[i]);
+                page->lines[i] = line;
+            }
+        }
+        addr += num;
+    }
+}
+
+namespace
+{
+    struct LineHash
+    {
+        template<typename Line>
+        size_t operator()(Line const & line) const { return std::hash<std::string>()(line.text); }
+    };
+
+    struct LineEqual
+    {
+        template<typename Line>
+        bool operator()(Line const & lhs, Line const & rhs) const { return lhs.text == rhs.text; }
+    };
+};
+
+lc3::core::MemLineTable::Line const * lc3::core::MemLineTable::intern(std::string const & text)
+{
+    // Elements of an unordered_set keep their address when it rehashes, so the pointers handed out stay valid until
+    // they are erased.  References are only taken from 0 here, under the lock, so a line the sweep finds unreferenced
+    // can't be picked up again while it is erased.  The pool is never destroyed, so that pages that outlive it at exit
+    // can still drop their references.
+    static std::mutex pool_mutex;
+    static std::unordered_set<Line, LineHash, LineEqual> & pool = *new std::unordered_set<Line, LineHash, LineEqual>();
+    static size_t sweep_size = 1024;
+
+    std::lock_guard<std::mutex> const lock(pool_mutex);
+    Line const * line = &*pool.emplace(text).first;
+    hold(line);
+
+    // Lines no page holds any more are dropped once the pool has doubled since the last time.
+    if(pool.size() >= sweep_size) {
+        for(auto it = pool.begin(); it != pool.end();) {
+            it = it->refs.load(std::memory_order_acquire) == 0 ? pool.erase(it) : std::next(it);
+        }
+        sweep_size = std::max<size_t>(1024, pool.size() * 2);
+    }
+    return line;
+}
+
+void lc3::core::MemLineTable::hold(Line const * line)
+{
+    if(line != nullptr) {
+        line->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void lc3::core::MemLineTable::release(Line const * line)
+{
+    if(line != nullptr) {
+        line->refs.fetch_sub(1, std::memory_order_release);
+    }
+}
@@ -4,8 +4,16 @@
 #ifndef MEM_NEW_H
 #define MEM_NEW_H
 
-#include <string>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace lc3
 {
@@ -37,6 +45,113 @@ namespace core
 
     std::ostream & operator<<(std::ostream & out, MemLocation const & in);
     std::istream & operator>>(std::istream & in, MemLocation & out);
+
+    // Returns a page with the same contents as page from a pool shared by every machine in the process, which is page
+    // itself if the pool had none, so that machines holding the same data, such as the OS or a program many of them
+    // load, hold a single copy of it.  Pages in the pool are marked as shared and must never be written again; a
+    // machine that wants to change one replaces it with a private copy first.  The pool only keeps pages while some
+    // machine or snapshot holds them.
+    template<typename Page, typename Value, size_t size>
+    std::shared_ptr<Page> sharePage(std::shared_ptr<Page> const & page, Value (Page::*contents)[size])
+    {
+        static_assert((sizeof(Value) * size) % sizeof(uint64_t) == 0, "page contents must be a multiple of 8 bytes");
+
+        static std::mutex pool_mutex;
+        static std::unordered_multimap<uint64_t, std::weak_ptr<Page>> pool;
+        static size_t sweep_size = 1024;
+
+        unsigned char const * bytes = reinterpret_cast<unsigned char const *>((*page).*contents);
+        size_t const length = sizeof(Value) * size;
+        uint64_t hash = 0;
+        for(size_t i = 0; i < length; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
+        }
+
+        std::lock_guard<std::mutex> const lock(pool_mutex);
+        auto range = pool.equal_range(hash);
+        for(auto it = range.first; it != range.second; ++it) {
+            std::shared_ptr<Page> other = it->second.lock();
+            if(other != nullptr && std::memcmp((*other).*contents, bytes, length) == 0) {
+                return other;
+            }
+        }
+
+        page->shared = true;
+        pool.emplace(hash, page);
+        // Pages no machine holds any more are dropped once the pool has doubled since the last time.
+        if(pool.size() >= sweep_size) {
+            for(auto it = pool.begin(); it != pool.end();) {
+                it = it->second.expired() ? pool.erase(it) : std::next(it);
+            }
+            sweep_size = std::max<size_t>(1024, pool.size() * 2);
+        }
+        return page;
+    }
+
+    // A page of memory values.  Machines share pages with each other and with their snapshots until they write to
+    // them.
+    struct MemPage
+    {
+        static constexpr uint32_t BITS = 8;
+        static constexpr uint32_t SIZE = 1 << BITS;
+
+        bool shared;        // in the pool of pages shared between machines, see sharePage
+        uint16_t values[SIZE];
+    };
+
+    // Source lines for memory locations, kept apart from their values.  The text is interned in a pool shared by
+    // every machine in the process, so the OS, or a program loaded into many machines, is only stored once; like the
+    // page pool, it only keeps lines while some page holds them.  Each machine only allocates line pointers for the
+    // pages that have lines.  Copies of a table share pages until one of them sets a line in it, and share shares them
+    // with every other machine that has the same lines.
+    class MemLineTable
+    {
+    public:
+        MemLineTable(void);
+
+        std::string const & get(uint16_t addr) const;
+        void set(uint16_t addr, std::string const & line);
+        void clear(void);
+        void share(void);
+        // Sets the lines of count locations from start to those in another table.
+        void copy(MemLineTable const & from, uint16_t start, uint32_t count);
+
+    private:
+        static constexpr uint32_t PAGE_BITS = 8;
+        static constexpr uint32_t PAGE_SIZE = 1 << PAGE_BITS;
+
+        struct Line
+        {
+            std::string text;
+            // Slots in pages that point to the line.  Lines no page points to are dropped from the pool when it is
+            // next swept.
+            mutable std::atomic<uint32_t> refs;
+
+            Line(std::string const & text) : text(text), refs(0) { }
+        };
+
+        struct Page
+        {
+            bool shared;
+            Line const * lines[PAGE_SIZE];
+
+            Page(void);
+            Page(Page const & other);
+            ~Page(void);
+            Page & operator=(Page const &) = delete;
+        };
+
+        std::vector<std::shared_ptr<Page>> pages;
+
+        // Returns the line in the pool with the given text, with a reference taken for the caller.
+        static Line const * intern(std::string const & text);
+        // Take and drop a reference to a line, which may be null.
+        static void hold(Line const * line);
+        static void release(Line const * line);
+    };
 };
 };
 
@@ -4,6 +4,7 @@
 #ifndef PRINTER_H
 #define PRINTER_H
 
+#include <cstddef>
 #include <string>
 
 namespace lc3
@@ -43,6 +44,18 @@ namespace utils
         virtual void setColor(PrintColor color) = 0;
         virtual void print(std::string const & string) = 0;
         virtual void newline(void) = 0;
+        // Prints a run of characters without newlines, such as the output of the display.  Printers that can take
+        // characters in bulk should override it; by default the run is passed to print as a string.
+        virtual void printChars(char const * chars, size_t count) { print(std::string(chars, count)); }
+    };
+
+    class NullPrinter : public IPrinter
+    {
+    public:
+        virtual void setColor(PrintColor) override {}
+        virtual void print(std::string const &) override {}
+        virtual void newline(void) override {}
+        virtual void printChars(char const *, size_t) override {}
     };
 };
 };
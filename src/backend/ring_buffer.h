@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace lc3
+{
+namespace utils
+{
+    // Fixed-capacity queue shared between one producer thread and one consumer thread without locks.  Only the
+    // producer may call push and full; only the consumer may call pop and clear.
+    template<typename T, size_t CAPACITY>
+    class SPSCRing
+    {
+        static_assert(CAPACITY != 0 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+    public:
+        SPSCRing(void) : head(0), tail(0) { }
+        SPSCRing(SPSCRing const &) = delete;
+        SPSCRing & operator=(SPSCRing const &) = delete;
+
+        bool push(T const & value)
+        {
+            size_t cur_tail = tail.load(std::memory_order_relaxed);
+            if(cur_tail - head.load(std::memory_order_acquire) == CAPACITY) { return false; }
+
+            slots[cur_tail & MASK] = value;
+            tail.store(cur_tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T & value)
+        {
+            size_t cur_head = head.load(std::memory_order_relaxed);
+            if(cur_head == tail.load(std::memory_order_acquire)) { return false; }
+
+            value = slots[cur_head & MASK];
+            head.store(cur_head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty(void) const
+        {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+        bool full(void) const
+        {
+            return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) == CAPACITY;
+        }
+
+        void clear(void) { head.store(tail.load(std::memory_order_acquire), std::memory_order_release); }
+
+    private:
+        static constexpr size_t MASK = CAPACITY - 1;
+
+        T slots[CAPACITY];
+        // Kept on separate cache lines so that the two threads don't contend on every access.
+        alignas(64) std::atomic<size_t> head;
+        alignas(64) std::atomic<size_t> tail;
+    };
+};
+};
+
+#endif
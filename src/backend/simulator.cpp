@@ -8,21 +8,27 @@
 
 #include "decoder.h"
 #include "device_regs.h"
+#include "isa.h"
+#include "uop.h"
 
 using namespace lc3::core;
 
 static constexpr uint64_t INST_TIMESTEP = 20;
 
 Simulator::Simulator(lc3::utils::IPrinter & printer, lc3::utils::IInputter & inputter, uint32_t print_level) :
-    time(0), logger(printer, print_level)
+    time(0), any_device_polled(false), logger(printer, print_level), progress_interval(0), next_progress(0),
+    next_watch_id(1),
+    engine(EngineType::FUNCTIONAL), functional_running(false), suspend_requested(false)
 {
-    devices.emplace_back(std::make_shared<KeyboardDevice>(inputter));
-    devices.emplace_back(std::make_shared<DisplayDevice>(logger));
+    devices.emplace_back(std::make_shared<KeyboardDevice>(inputter, state.getMicroOpArena()));
+    display = std::make_shared<DisplayDevice>(logger);
+    devices.emplace_back(display);
 
     for(PIDevice dev : devices) {
         for(uint16_t dev_addr : dev->getAddrMap()) {
             state.registerDeviceReg(dev_addr, dev);
         }
+        dev->attachScheduler(device_scheduler);
     }
 
     setup(0);
@@ -32,19 +38,50 @@ void Simulator::simulate(void)
 {
     powerOn(0);
     inst_count_this_run = 0;
+    next_progress = progress_interval;
+    sub_depth = run_limits.start_depth;
     async_interrupt = false;
+    functional_running = false;
+    last_break = BreakHit();
+    // Only accesses made by this run's instructions can trigger watchpoints.
+    state.clearWatchedAccesses();
 
     sim::Decoder decoder;
 
-    // Initialize devices.
+    // Initialize devices.  Every device is ticked before the first instruction, after which the functional engine
+    // only ticks the ones that are polled or asked for it.
+    device_scheduler.setStep(0);
+    device_scheduler.beginPass();
+    device_polled.clear();
+    any_device_polled = false;
     for(PIDevice dev : devices) {
         dev->startup();
+        dev->requestTick();
+        device_polled.push_back(dev->isPolled());
+        any_device_polled = any_device_polled || device_polled.back();
     }
 
-    do {
-        handleDevices();
-        handleInstruction(decoder);
-    } while(lc3::utils::getBit(state.readMCR(), 15) == 1 && ! async_interrupt);
+    // The event trace printed at P_EXTRA is only produced by the cycle-timed engine.
+    if(engine == EngineType::CYCLE_TIMED ||
+        logger.getPrintLevel() >= static_cast<uint32_t>(lc3::utils::PrintType::P_EXTRA))
+    {
+        do {
+            state.getMicroOpArena().reset();
+            handleDevices();
+            handleInstruction(decoder);
+            // Keep the output in step with the event trace.
+            display->flush();
+        } while(lc3::utils::getBit(state.readMCR(), 15) == 1 && ! async_interrupt);
+    } else {
+        functional_running = true;
+        suspend_requested = false;
+        do {
+            state.getMicroOpArena().reset();
+            handleDevicesFunctional();
+            handleInstructionFunctional(decoder);
+        } while(lc3::utils::getBit(state.readMCR(), 15) == 1 && ! async_interrupt);
+        functional_running = false;
+    }
     // While this loop is running, async_interrupt will only be read by this thread.  It may be written by another
     // thread, such as in the context of a GUI running the simulator asynchronously, but even then there will only
     // by a single writer and a single reader.  Thus, async_interrupt is left unprotected by mutexes.
@@ -59,71 +96,184 @@ void Simulator::simulate(void)
 
 void Simulator::loadObj(std::string const & name, std::istream & buffer)
 {
-    events.emplace(std::make_shared<LoadObjFileEvent>(time + 1, name, buffer, logger));
+    events.emplace<LoadObjFileEvent>(time + 1, name, buffer, logger);
     setup(2);
 
     executeEvents();
+    // Other machines may well have loaded the same thing.
+    state.sharePages();
+}
+
+void Simulator::loadImage(MemImage const & image)
+{
+    state.loadImage(image);
+    // Images are only loaded below user space, so the machine resets to the start of it as it would after loading
+    // the same blocks from an object file.
+    state.writeResetPC(USER_START);
+    setup(2);
+
+    state.sharePages();
 }
 
 void Simulator::setup(uint64_t t_delta)
 {
-    events.emplace(std::make_shared<SetupEvent>(time + t_delta));
+    events.emplace<SetupEvent>(time + t_delta);
     executeEvents();
+    // Outside of a run, nothing else frees the micro-ops the events were made of.
+    state.getMicroOpArena().reset();
 }
 
 void Simulator::reinitialize(void)
 {
     state.reinitialize();
+    state.getMicroOpArena().reset();
+    block_cache.flush(state);
+    jit.flush();
+    applyWatchpoints();
+}
+
+PMachineSnapshot Simulator::snapshot(void) const
+{
+    return state.snapshot(stack_trace);
+}
+
+void Simulator::restore(MachineSnapshot const & snapshot)
+{
+    state.restore(snapshot, stack_trace);
+    // Code translated from the memory that was replaced is stale.
+    block_cache.flush(state);
+    jit.flush();
 }
 
 void Simulator::triggerSuspend()
 {
-    while(! events.empty()) { events.pop(); }
-    events.emplace(std::make_shared<ShutdownEvent>(time));
+    if(functional_running) {
+        suspend_requested = true;
+        return;
+    }
+
+    events.clear();
+    events.emplace<ShutdownEvent>(time);
 }
 
 void Simulator::registerCallback(CallbackType type, Callback func)
 {
-    callbacks[type] = func;
+    callbacks.set(type, func);
+}
+
+void Simulator::setProgressListener(ProgressListener listener, uint64_t interval)
+{
+    progress_listener = listener;
+    progress_interval = listener != nullptr ? std::max<uint64_t>(interval, 1) : 0;
+    next_progress = inst_count_this_run + progress_interval;
 }
 
 void Simulator::addBreakpoint(uint16_t pc)
 {
-    breakpoints.insert(pc);
+    addBreakpoint(pc, BreakCondition(), 0);
+}
+
+void Simulator::addBreakpoint(uint16_t pc, BreakCondition const & condition, uint64_t ignore_count)
+{
+    Breakpoint & breakpoint = breakpoints[pc];
+    breakpoint = Breakpoint();
+    breakpoint.addr = pc;
+    breakpoint.condition = condition;
+    breakpoint.ignore_count = ignore_count;
+    breakpoint_addrs.set(pc);
 }
 
 void Simulator::removeBreakpoint(uint16_t pc)
 {
     breakpoints.erase(pc);
+    breakpoint_addrs.reset(pc);
+}
+
+Breakpoint const * Simulator::getBreakpoint(uint16_t pc) const
+{
+    auto search = breakpoints.find(pc);
+    return search != breakpoints.end() ? &search->second : nullptr;
+}
+
+uint32_t Simulator::addWatchpoint(uint16_t start, uint16_t end, WatchType type, BreakCondition const & condition,
+    uint64_t ignore_count)
+{
+    Watchpoint watchpoint;
+    watchpoint.id = next_watch_id;
+    watchpoint.start = std::min(start, end);
+    watchpoint.end = std::max(start, end);
+    watchpoint.type = type;
+    watchpoint.condition = condition;
+    watchpoint.ignore_count = ignore_count;
+    watchpoints.push_back(watchpoint);
+    next_watch_id += 1;
+
+    applyWatchpoints();
+    return watchpoint.id;
+}
+
+void Simulator::removeWatchpoint(uint32_t id)
+{
+    watchpoints.erase(std::remove_if(watchpoints.begin(), watchpoints.end(),
+        [id](Watchpoint const & watchpoint) { return watchpoint.id == id; }), watchpoints.end());
+    applyWatchpoints();
+}
+
+Watchpoint const * Simulator::getWatchpoint(uint32_t id) const
+{
+    for(Watchpoint const & watchpoint : watchpoints) {
+        if(watchpoint.id == id) {
+            return &watchpoint;
+        }
+    }
+    return nullptr;
+}
+
+void Simulator::applyWatchpoints(void)
+{
+    state.clearAccessWatches();
+    for(Watchpoint const & watchpoint : watchpoints) {
+        for(uint32_t addr = watchpoint.start; addr <= watchpoint.end && addr < MMIO_START; addr += 1) {
+            state.addAccessWatch(static_cast<uint16_t>(addr), watchpoint.type != WatchType::WRITE,
+                watchpoint.type != WatchType::READ);
+        }
+    }
 }
 
 void Simulator::powerOn(uint64_t t_delta)
 {
-    events.emplace(std::make_shared<PowerOnEvent>(time + t_delta));
+    events.emplace<PowerOnEvent>(time + t_delta);
     executeEvents();
 }
 
 void Simulator::executeEvents(void)
 {
     while(! events.empty()) {
-        PIEvent event = events.top();
-        events.pop();
+        PIEvent event = events.pop();
 
         if(event != nullptr) {
             if(event->time < time) {
-                logger.printf(lc3::utils::PrintType::P_NOTE, true, "%d: Skipping '%s' scheduled for %d", time,
-                    event->toString(state).c_str(), event->time);
+                logger.printfLazy(lc3::utils::PrintType::P_NOTE, true, [this, &event](void) {
+                    return lc3::utils::ssprintf("%d: Skipping '%s' scheduled for %d", time,
+                        event->toString(state).c_str(), event->time);
+                });
                 logger.newline(lc3::utils::PrintType::P_NOTE);
                 continue;
             }
 
             time = event->time;
-            logger.printf(lc3::utils::PrintType::P_EXTRA, true, "%d: %s", time, event->toString(state).c_str());
+            bool trace = logger.isEnabled(lc3::utils::PrintType::P_EXTRA);
+            if(trace) {
+                logger.printf(lc3::utils::PrintType::P_EXTRA, true, "%d: %s", time, event->toString(state).c_str());
+            }
             event->handleEvent(state);
 
             PIMicroOp uop = event->uops;
             while(uop != nullptr) {
-                logger.printf(lc3::utils::PrintType::P_EXTRA, true, "%d: |- %s", time, uop->toString(state).c_str());
+                if(trace) {
+                    logger.printf(lc3::utils::PrintType::P_EXTRA, true, "%d: |- %s", time,
+                        uop->toString(state).c_str());
+                }
                 uop->handleMicroOp(state);
                 uop = uop->getNext();
             }
@@ -137,14 +287,20 @@ void Simulator::handleDevices(void)
 {
     uint64_t fetch_time_offset = INST_TIMESTEP - (time % INST_TIMESTEP);
 
+    uint64_t check_time = time + fetch_time_offset - 9;
+
     // Insert device update events.
     for(PIDevice dev : devices) {
-        events.emplace(std::make_shared<DeviceUpdateEvent>(time + fetch_time_offset - 10, dev));
+        events.emplace<DeviceUpdateEvent>(time + fetch_time_offset - 10, dev);
     }
-
-    // Check for interrupts triggered by devices.
-    events.emplace(std::make_shared<CheckForInterruptEvent>(time + fetch_time_offset - 9));
     executeEvents();
+
+    // Check for interrupts triggered by devices, which can only have a different outcome from the last check if an
+    // interrupt was raised or the priority level changed since.  The event trace shows every check.
+    if(state.needsInterruptCheck() || logger.isEnabled(lc3::utils::PrintType::P_EXTRA)) {
+        events.emplace<CheckForInterruptEvent>(check_time);
+        executeEvents();
+    }
 }
 
 void Simulator::handleInstruction(sim::Decoder & decoder)
@@ -152,8 +308,8 @@ void Simulator::handleInstruction(sim::Decoder & decoder)
     uint64_t fetch_time_offset = INST_TIMESTEP - (time % INST_TIMESTEP);
 
     // Either insert breakpoints event or normal processing.
-    auto bp_search = std::find(breakpoints.begin(), breakpoints.end(), state.readPC());
-    if(bp_search != breakpoints.end() && inst_count_this_run != 0) {
+    uint16_t pc = state.readPC();
+    if(breakpoint_addrs.test(pc) && inst_count_this_run != 0 && checkBreakpoint(pc)) {
         // Insert suspend event and breakpoint callbacks.
         triggerSuspend();
         triggerCallback(fetch_time_offset, CallbackType::BREAKPOINT);
@@ -165,7 +321,7 @@ void Simulator::handleInstruction(sim::Decoder & decoder)
         handleCallbacks(fetch_time_offset);
 
         // Insert instruction fetch event.
-        events.emplace(std::make_shared<AtomicInstProcessEvent>(time + fetch_time_offset, decoder));
+        events.emplace<AtomicInstProcessEvent>(time + fetch_time_offset, decoder);
         executeEvents();
 
         // Insert post-instruction callback and any other callbacks generated during execution.
@@ -187,45 +343,354 @@ void Simulator::handleCallbacks(uint64_t t_delta)
 
 void Simulator::triggerCallback(uint64_t t_delta, CallbackType type)
 {
-    events.emplace(std::make_shared<CallbackEvent>(
-        time + t_delta + callbackTypeToUnderlying(type), type,
-        std::bind(callbackDispatcher, this, type, std::placeholders::_2)
-    ));
+    events.emplace<CallbackEvent>(time + t_delta + callbackTypeToUnderlying(type), type, this, callbackDispatcher);
+}
+
+void Simulator::handleDevicesFunctional(void)
+{
+    tickDevices();
+
+    if(state.needsInterruptCheck()) {
+        CheckForInterruptEvent check(time);
+        check.handleEvent(state);
+        executeMicroOps(check.uops);
+    }
+}
+
+void Simulator::handleInstructionFunctional(sim::Decoder & decoder)
+{
+    uint16_t pc = state.readPC();
+    if(breakpoint_addrs.test(pc) && inst_count_this_run != 0 && checkBreakpoint(pc)) {
+        state.writeMCR(state.readMCR() & 0x7FFF);
+        dispatchCallback(CallbackType::BREAKPOINT);
+        return;
+    }
+
+    // Callbacks are dispatched in the order the event queue would process them, i.e. by their time offset relative
+    // to the instruction.  A suspend drops the remainder of the phase it was requested in.
+    auto take_pending = [this](void) {
+        callback_scratch.assign(state.getPendingCallbacks().begin(), state.getPendingCallbacks().end());
+        state.clearPendingCallbacks();
+        std::sort(callback_scratch.begin(), callback_scratch.end(), [](CallbackType lhs, CallbackType rhs) {
+            return callbackTypeToUnderlying(lhs) < callbackTypeToUnderlying(rhs);
+        });
+    };
+
+    take_pending();
+    if(dispatchCallback(CallbackType::PRE_INST) && dispatchPendingCallbacks(true)) {
+        executeInstruction(decoder);
+        dispatchPendingCallbacks(false);
+    }
+
+    take_pending();
+    if(dispatchPendingCallbacks(true) && dispatchPendingCallbacks(false)) {
+        dispatchCallback(CallbackType::POST_INST);
+    }
+}
+
+void Simulator::executeInstruction(sim::Decoder & decoder)
+{
+    MicroOpArena & arena = state.getMicroOpArena();
+
+    uint16_t pc = state.readPC();
+    if(isAccessViolation(pc, state)) {
+        executeMicroOps(arena.make<FetchMicroOp>());
+        return;
+    }
+
+    sim::TranslatedOp const * op = block_cache.lookup(pc, state);
+    if(op != nullptr && engine == EngineType::JIT && block_cache.isAtBlockStart() && canFuseInstructions()) {
+        sim::TranslatedOp const * last = nullptr;
+        uint64_t budget = UINT64_MAX;
+        if(run_limits.inst_limit != 0) {
+            // Native code may overshoot its budget by up to a block.
+            uint64_t remaining = run_limits.inst_limit - inst_count_this_run;
+            budget = remaining > sim::BlockCache::MAX_BLOCK_LENGTH ? remaining - sim::BlockCache::MAX_BLOCK_LENGTH : 0;
+        }
+        if(progress_interval != 0) {
+            // Only stretches before the next progress report are run natively, so that reports stay on time.
+            budget = std::min(budget, next_progress > inst_count_this_run ? next_progress - inst_count_this_run : 1);
+        }
+        uint64_t count = budget != 0 ? jit.run(block_cache, state, last, budget) : 0;
+        if(count != 0) {
+            // As with fused instructions, all that's left of the boundaries between natively executed instructions
+            // is the instruction count and the device ticks.
+            inst_count_this_run += count - 1;
+            pre_inst_pc = last->pc;
+            tickDevicesIdle(count - 1);
+            state.writeIR(last->decoded->value);
+            state.writeDecodedIR(last->decoded);
+            return;
+        }
+    }
+
+    if(op == nullptr) {
+        // Illegal instructions and code in the device register page are never cached.
+        uint16_t ir = std::get<0>(state.readMem(pc));
+        state.writeIR(ir);
+        state.writePC(pc + 1);
+
+        DecodedInstruction const * decoded = decoder.decode(ir);
+        if(decoded == nullptr) {
+            executeMicroOps(arena.make<DecodeMicroOp>(decoder));
+            return;
+        }
+        state.writeDecodedIR(decoded);
+
+        sim::TranslatedOp uncached = sim::translateInstruction(pc, decoded);
+        executeMicroOps(uncached.handler(state, uncached));
+        return;
+    }
+
+    state.writeIR(op->decoded->value);
+    state.writePC(pc + 1);
+    state.writeDecodedIR(op->decoded);
+
+    sim::TranslatedOp const * next = op->fused != nullptr ? block_cache.peekNext() : nullptr;
+    if(next != nullptr && canFuseInstructions() && op->fused(state, *op, *next)) {
+        block_cache.advance();
+
+        // Nothing could observe the boundary between the two instructions, so all that's left of it is the
+        // instruction count and the device ticks.  Neither instruction after the first reads memory, so ticking the
+        // devices afterwards is indistinguishable from ticking them in between.
+        inst_count_this_run += 1;
+        pre_inst_pc = next->pc;
+        tickDevices();
+        state.writeIR(next->decoded->value);
+        state.writeDecodedIR(next->decoded);
+    } else {
+        executeMicroOps(op->handler(state, *op));
+    }
+}
+
+void Simulator::tickDevices(void)
+{
+    device_scheduler.setStep(device_scheduler.getStep() + 1);
+    if(! any_device_polled && device_scheduler.getNextWakeup() > device_scheduler.getStep()) { return; }
+
+    device_scheduler.beginPass();
+    for(size_t i = 0; i < devices.size(); i += 1) {
+        bool due = devices[i]->takeWakeup();
+        if(due || device_polled[i]) {
+            executeMicroOps(devices[i]->tick());
+        }
+    }
+}
+
+void Simulator::tickDevicesIdle(uint64_t count)
+{
+    uint64_t const end = device_scheduler.getStep() + count;
+    for(size_t i = 0; i < devices.size(); i += 1) {
+        if(device_polled[i]) {
+            devices[i]->tickIdle(count);
+        }
+    }
+
+    // Nothing accesses the devices in this span, so only the wakeups they request from their own ticks matter.
+    while(device_scheduler.getStep() < end) {
+        uint64_t wakeup = std::max(device_scheduler.getNextWakeup(), device_scheduler.getStep() + 1);
+        if(wakeup > end) { break; }
+
+        device_scheduler.setStep(wakeup);
+        device_scheduler.beginPass();
+        for(size_t i = 0; i < devices.size(); i += 1) {
+            if(devices[i]->takeWakeup() && ! device_polled[i]) {
+                devices[i]->tickIdle(1);
+            }
+        }
+    }
+    device_scheduler.setStep(end);
+}
+
+bool Simulator::canFuseInstructions(void) const
+{
+    if(! breakpoints.empty() || ! watchpoints.empty() || state.peekInterrupt() != InterruptType::INVALID) {
+        return false;
+    }
+
+    if(callbacks.has(CallbackType::PRE_INST) || callbacks.has(CallbackType::POST_INST)) {
+        return false;
+    }
+
+    // The run limits are only checked after the last of the instructions run together.
+    if((run_limits.stop_at_depth && sub_depth == 0) ||
+        (run_limits.inst_limit != 0 && inst_count_this_run + 2 > run_limits.inst_limit))
+    {
+        return false;
+    }
+
+    for(PIDevice const & dev : devices) {
+        if(dev->canInterrupt()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Simulator::checkBreakpoint(uint16_t pc)
+{
+    Breakpoint & breakpoint = breakpoints[pc];
+    if(! breakpoint.condition.evaluate(state)) {
+        return false;
+    }
+
+    breakpoint.hit_count += 1;
+    if(breakpoint.hit_count <= breakpoint.ignore_count) {
+        return false;
+    }
+
+    last_break = BreakHit();
+    last_break.kind = BreakHit::Kind::BREAKPOINT;
+    last_break.pc = pc;
+    return true;
+}
+
+bool Simulator::checkWatchpoints(void)
+{
+    std::vector<MachineState::WatchedAccess> const & accesses = state.getWatchedAccesses();
+
+    // Every watchpoint the instruction triggered counts a hit, but only the first to stop the run is reported.
+    bool stop = false;
+    for(Watchpoint & watchpoint : watchpoints) {
+        for(MachineState::WatchedAccess const & access : accesses) {
+            if(access.addr < watchpoint.start || access.addr > watchpoint.end ||
+                watchpoint.type == (access.write ? WatchType::READ : WatchType::WRITE))
+            {
+                continue;
+            }
+
+            if(watchpoint.condition.evaluate(state)) {
+                watchpoint.hit_count += 1;
+                if(! stop && watchpoint.hit_count > watchpoint.ignore_count) {
+                    stop = true;
+                    last_break = BreakHit();
+                    last_break.kind = BreakHit::Kind::WATCHPOINT;
+                    last_break.pc = pre_inst_pc;
+                    last_break.watch_id = watchpoint.id;
+                    last_break.addr = access.addr;
+                    last_break.write = access.write;
+                }
+            }
+            break;
+        }
+    }
+
+    state.clearWatchedAccesses();
+    return stop;
+}
+
+bool Simulator::dispatchCallback(CallbackType type)
+{
+    callbackDispatcher(this, type, state);
+
+    if(suspend_requested) {
+        suspend_requested = false;
+        state.writeMCR(state.readMCR() & 0x7FFF);
+        return false;
+    }
+
+    return true;
+}
+
+bool Simulator::dispatchPendingCallbacks(bool before_inst)
+{
+    for(CallbackType type : callback_scratch) {
+        if((callbackTypeToUnderlying(type) < 0) == before_inst && ! dispatchCallback(type)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Simulator::executeMicroOps(PIMicroOp uop)
+{
+    while(uop != nullptr) {
+        uop->handleMicroOp(state);
+        uop = uop->getNext();
+    }
 }
 
 void Simulator::callbackDispatcher(Simulator * sim, CallbackType type, MachineState & state)
 {
+    RunLimits const & limits = sim->run_limits;
+
+    // A program that waits for input has likely printed a prompt for it, and an exception's message goes after
+    // whatever the program printed before it.
+    if(type == CallbackType::INPUT_POLL || type == CallbackType::INPUT_REQUEST || type == CallbackType::EX_ENTER) {
+        sim->display->flush();
+    }
+
     if(type == CallbackType::PRE_INST) {
         sim->pre_inst_pc = state.readPC();
+        if(limits.stop_on_halt && std::get<0>(state.readMem(sim->pre_inst_pc)) == 0xF025) {
+            sim->triggerSuspend();
+        }
     } else if(type == CallbackType::SUB_ENTER || type == CallbackType::EX_ENTER || type == CallbackType::INT_ENTER) {
         sim->stack_trace.push_back(sim->pre_inst_pc);
-        sim->logger.printf(lc3::utils::PrintType::P_DEBUG, true, "Stack trace");
-        for(int64_t i = sim->stack_trace.size() - 1; i >= 0; --i) {
-            uint16_t pc = sim->stack_trace[i];
-            sim->logger.printf(lc3::utils::PrintType::P_DEBUG, true, "#%d 0x%0.4hx (%s)",
-                sim->stack_trace.size() - 1 - i, pc, state.getMemLine(pc).c_str());
-        }
+        sim->printStackTrace();
         // if callback is an exception (e.g. access violation), we should show students which line caused it
         if (type == CallbackType::EX_ENTER) {
             uint16_t pc = sim->stack_trace[sim->stack_trace.size() - 1];
-            sim->logger.printf(lc3::utils::PrintType::P_ERROR, true, "PC before Exception: 0x%0.4hx (%s)",
-                pc, state.getMemLine(pc).c_str());
+            sim->logger.printfLazy(lc3::utils::PrintType::P_ERROR, true, [pc, &state](void) {
+                return lc3::utils::ssprintf("PC before Exception: 0x%0.4hx (%s)", pc, state.getMemLine(pc).c_str());
+            });
         }
+        ++(sim->sub_depth);
     } else if(type == CallbackType::SUB_EXIT || type == CallbackType::EX_EXIT || type == CallbackType::INT_EXIT) {
-        sim->stack_trace.pop_back();
-        sim->logger.printf(lc3::utils::PrintType::P_DEBUG, true, "Stack trace");
-        for(int64_t i = sim->stack_trace.size() - 1; i >= 0; --i) {
-            uint16_t pc = sim->stack_trace[i];
-            sim->logger.printf(lc3::utils::PrintType::P_DEBUG, true, "#%d 0x%0.4hx (%s)",
-                sim->stack_trace.size() - 1 - i, pc, state.getMemLine(pc).c_str());
+        // Exits are decided by the subroutine trace in the machine state, which may be out of step with the stack trace.
+        if(! sim->stack_trace.empty()) {
+            sim->stack_trace.pop_back();
+        }
+        sim->printStackTrace();
+        if(sim->sub_depth > 0) {
+            --(sim->sub_depth);
         }
     } else if(type == CallbackType::POST_INST) {
         ++(sim->inst_count_this_run);
+        if((limits.inst_limit != 0 && sim->inst_count_this_run >= limits.inst_limit) ||
+            (limits.stop_at_depth && sim->sub_depth == 0))
+        {
+            sim->triggerSuspend();
+        }
+        // Instructions that were run together are only counted here, so the count may have gone past the mark.
+        if(sim->progress_interval != 0 && sim->inst_count_this_run >= sim->next_progress) {
+            sim->next_progress = sim->inst_count_this_run + sim->progress_interval;
+            sim->display->flush();
+            sim->progress_listener(state);
+        }
+        // A watchpoint stops the run after the instruction that triggered it, at which point it is too late to
+        // schedule a breakpoint callback, so the callback is made from here.
+        if(! state.getWatchedAccesses().empty() && sim->checkWatchpoints()) {
+            sim->triggerSuspend();
+            if(sim->callbacks.has(CallbackType::BREAKPOINT)) {
+                sim->callbacks.get(CallbackType::BREAKPOINT)(CallbackType::BREAKPOINT, state);
+            }
+        }
+    } else if(type == CallbackType::INPUT_REQUEST && limits.stop_on_input_request) {
+        sim->triggerSuspend();
+    }
+
+    if(sim->callbacks.has(type)) {
+        // Listeners may look at what has been printed so far.
+        sim->display->flush();
+        sim->callbacks.get(type)(type, state);
+    }
+}
+
+void Simulator::printStackTrace(void) const
+{
+    if(! logger.isEnabled(lc3::utils::PrintType::P_DEBUG)) {
+        return;
     }
 
-    auto search = sim->callbacks.find(type);
-    if(search != sim->callbacks.end() && search->second != nullptr) {
-        search->second(type, state);
+    display->flush();
+    logger.printf(lc3::utils::PrintType::P_DEBUG, true, "Stack trace");
+    for(int64_t i = stack_trace.size() - 1; i >= 0; --i) {
+        uint16_t pc = stack_trace[i];
+        logger.printf(lc3::utils::PrintType::P_DEBUG, true, "#%d 0x%0.4hx (%s)", stack_trace.size() - 1 - i, pc,
+            state.getMemLine(pc).c_str());
     }
 }
 
@@ -233,3 +698,8 @@ MachineState & Simulator::getMachineState(void) { return state; }
 MachineState const & Simulator::getMachineState(void) const { return state; }
 void Simulator::setPrintLevel(uint32_t print_level) { logger.setPrintLevel(print_level); }
 void Simulator::setIgnorePrivilege(bool ignore_privilege) { state.setIgnorePrivilege(ignore_privilege); }
+void Simulator::setEngine(EngineType engine) { this->engine = engine; }
+EngineType Simulator::getEngine(void) const { return engine; }
+sim::BlockCacheStats const & Simulator::getBlockCacheStats(void) const { return block_cache.getStats(); }
+sim::JitStats const & Simulator::getJitStats(void) const { return jit.getStats(); }
+uint64_t Simulator::getInstExecCount(void) const { return inst_count_this_run; }
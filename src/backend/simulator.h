@@ -4,72 +4,133 @@
 #ifndef SIMULATOR_H
 #define SIMULATOR_H
 
+#include <bitset>
 #include <cstdint>
 #include <unordered_map>
-#include <queue>
-#include <set>
 
+#include "breakpoint.h"
 #include "inputter.h"
 #include "event.h"
+#include "event_queue.h"
 #include "logger.h"
 #include "printer.h"
 #include "state.h"
+#include "jit.h"
+#include "translator.h"
 
-namespace std
+namespace lc3
+{
+namespace core
 {
-    using namespace lc3::core;
+    enum class EngineType
+    {
+          FUNCTIONAL = 0
+        , CYCLE_TIMED
+        , JIT           // functional, with hot code compiled to native code where supported
+    };
 
-    template<> struct greater<PIEvent>
+    // Conditions that end a run early.  They are checked inline as the run goes rather than through callbacks.
+    struct RunLimits
     {
-        bool operator()(PIEvent lhs, PIEvent rhs)
-        {
-            return std::greater<uint64_t>()(lhs->time, rhs->time);
-        }
+        bool stop_on_halt;              // before a HALT instruction
+        bool stop_on_input_request;     // when a read of KBDR finds no input left
+        uint64_t inst_limit;            // once this many instructions have run, if not 0
+        bool stop_at_depth;             // after an instruction that leaves the subroutine depth at 0
+        // Subroutine depth at the start of the run.  Entering a subroutine, exception or interrupt adds one; leaving
+        // one takes one away.
+        uint64_t start_depth;
+
+        RunLimits(void) : stop_on_halt(false), stop_on_input_request(false), inst_limit(0), stop_at_depth(false),
+            start_depth(0) { }
     };
-};
 
-namespace lc3
-{
-namespace core
-{
     class Simulator
     {
     public:
         using Callback = std::function<void(CallbackType, MachineState &)>;
+        using ProgressListener = std::function<void(MachineState const &)>;
 
         Simulator(lc3::utils::IPrinter & printer, lc3::utils::IInputter & inputter, uint32_t print_level);
         void simulate(void);
         void loadObj(std::string const & name, std::istream & buffer);
+        // Loads an image that is already in memory, such as the OS, without going through an object file.
+        void loadImage(MemImage const & image);
         void setup(uint64_t t_delta = 0);
         void reinitialize(void);
+        PMachineSnapshot snapshot(void) const;
+        void restore(MachineSnapshot const & snapshot);
         void triggerSuspend();
         void registerCallback(CallbackType type, Callback func);
+        // Called from the running thread after every interval instructions of a run, once the display output so far
+        // has been printed.  Unlike an instruction callback, it does not stop instructions from being run together.
+        void setProgressListener(ProgressListener listener, uint64_t interval);
+        // Applies to every following run.
+        void setRunLimits(RunLimits const & limits) { run_limits = limits; }
         void addBreakpoint(uint16_t pc);
+        // Replaces any breakpoint already at pc.
+        void addBreakpoint(uint16_t pc, BreakCondition const & condition, uint64_t ignore_count);
         void removeBreakpoint(uint16_t pc);
+        // Returns nullptr if there is no breakpoint at pc.
+        Breakpoint const * getBreakpoint(uint16_t pc) const;
+        // Returns an ID for removeWatchpoint.  Watchpoints stop the run by dispatching the breakpoint callback.
+        uint32_t addWatchpoint(uint16_t start, uint16_t end, WatchType type, BreakCondition const & condition,
+            uint64_t ignore_count);
+        void removeWatchpoint(uint32_t id);
+        // Returns nullptr if there is no watchpoint with the ID.
+        Watchpoint const * getWatchpoint(uint32_t id) const;
+        BreakHit const & getLastBreak(void) const { return last_break; }
         MachineState & getMachineState(void);
         MachineState const & getMachineState(void) const;
         void asyncInterrupt(void) { async_interrupt = true; }
 
         void setPrintLevel(uint32_t print_level);
         void setIgnorePrivilege(bool ignore_privilege);
+        void setEngine(EngineType engine);
+        EngineType getEngine(void) const;
+        sim::BlockCacheStats const & getBlockCacheStats(void) const;
+        sim::JitStats const & getJitStats(void) const;
+        uint64_t getInstExecCount(void) const;
 
     private:
-        std::priority_queue<PIEvent, std::vector<PIEvent>, std::greater<PIEvent>> events;
+        sim::EventQueue events;
         uint64_t time;
 
         MachineState state;
         std::vector<PIDevice> devices;
+        std::shared_ptr<DisplayDevice> display;
+        // The functional engine only ticks polled devices and the devices the scheduler says are due.
+        DeviceScheduler device_scheduler;
+        std::vector<bool> device_polled;
+        bool any_device_polled;
 
         lc3::utils::Logger logger;
 
-        std::unordered_map<CallbackType, Callback> callbacks;
-        std::set<uint16_t> breakpoints;
+        CallbackRegistry<Callback> callbacks;
+        ProgressListener progress_listener;
+        uint64_t progress_interval;
+        uint64_t next_progress;
+        // Whether each address has a breakpoint, so that the instructions without one cost a single test.  Their
+        // conditions and hit counts are only looked up for the addresses that do.
+        std::bitset<0x10000> breakpoint_addrs;
+        std::unordered_map<uint16_t, Breakpoint> breakpoints;
+        std::vector<Watchpoint> watchpoints;
+        uint32_t next_watch_id;
+        BreakHit last_break;
+        RunLimits run_limits;
 
         uint64_t inst_count_this_run;
+        uint64_t sub_depth;
         uint16_t pre_inst_pc;
         std::vector<uint16_t> stack_trace;
         bool async_interrupt;
 
+        EngineType engine;
+        bool functional_running;
+        bool suspend_requested;
+        std::vector<CallbackType> callback_scratch;
+        sim::BlockCache block_cache;
+        sim::Jit jit;
+
         void powerOn(uint64_t t_delta);
         void executeEvents(void);
         void handleDevices(void);
@@ -77,6 +138,22 @@ namespace core
         void handleCallbacks(uint64_t t_delta);
         void triggerCallback(uint64_t t_delta, CallbackType type);
 
+        // Functional engine: same per-instruction semantics as the event path above, dispatched directly.
+        void handleDevicesFunctional(void);
+        void tickDevices(void);
+        void tickDevicesIdle(uint64_t count);
+        void handleInstructionFunctional(sim::Decoder & decoder);
+        void executeInstruction(sim::Decoder & decoder);
+        bool canFuseInstructions(void) const;
+        bool checkBreakpoint(uint16_t pc);
+        bool checkWatchpoints(void);
+        void applyWatchpoints(void);
+        bool dispatchCallback(CallbackType type);
+        bool dispatchPendingCallbacks(bool before_inst);
+        void executeMicroOps(PIMicroOp uop);
+
+        void printStackTrace(void) const;
+
         static void callbackDispatcher(Simulator * sim, CallbackType type, MachineState & state);
     };
 };
@@ -1,19 +1,98 @@
 /*
  * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
  */
+#include <algorithm>
+#include <cstring>
+
 #include "device_regs.h"
 #include "device.h"
 #include "state.h"
 
 using namespace lc3::core;
 
-MachineState::MachineState(void) : reset_pc(RESET_PC), pc(0), ir(0), decoded_ir(nullptr), ssp(0),
-    ignore_privilege(false), first_init(true)
+namespace lc3
+{
+namespace core
+{
+    struct MachineSnapshot
+    {
+        std::vector<std::shared_ptr<MemPage>> mem_pages;
+        MemLineTable mem_lines;
+        std::vector<bool> stringz_cells;
+        std::vector<uint16_t> rf;
+        // In the order the devices were registered.
+        std::vector<PIDeviceState> devices;
+        uint16_t reset_pc, pc, ir;
+        uint16_t psr, mcr;
+        uint16_t ssp;
+        std::queue<InterruptType> pending_interrupts;
+        bool first_init;
+        std::stack<FuncType> func_trace;
+        std::vector<uint16_t> stack_trace;
+    };
+};
+};
+
+namespace
+{
+    // Exposes a register kept in the machine state at its address in the device register page.
+    class StateReg : public IDevice
+    {
+    public:
+        using Reader = uint16_t (MachineState::*)(void) const;
+        using Writer = void (MachineState::*)(uint16_t);
+
+        StateReg(MachineState & state, uint16_t data_addr, Reader reader, Writer writer) :
+            state(state), data_addr(data_addr), reader(reader), writer(writer) { }
+        virtual ~StateReg(void) override = default;
+
+        virtual std::pair<uint16_t, PIMicroOp> read(uint16_t addr) override
+        {
+            return std::make_pair(peek(addr), nullptr);
+        }
+        virtual PIMicroOp write(uint16_t addr, uint16_t value) override
+        {
+            if(addr == data_addr) {
+                (state.*writer)(value);
+            }
+            return nullptr;
+        }
+        virtual uint16_t peek(uint16_t addr) const override { return addr == data_addr ? (state.*reader)() : 0x0000; }
+        virtual std::vector<uint16_t> getAddrMap(void) const override { return { data_addr }; }
+        virtual std::string getName(void) const override { return "StateReg"; }
+
+    private:
+        MachineState & state;
+        uint16_t data_addr;
+        Reader reader;
+        Writer writer;
+    };
+};
+
+MemImage::MemImage(void) : mem_pages((MMIO_START - SYSTEM_START) / MemPage::SIZE) { }
+
+void MemImage::addBlock(uint16_t start, uint16_t const * values, char const * const * lines, uint32_t size)
+{
+    blocks.push_back(Block{start, size});
+    for(uint32_t i = 0; i < size; i += 1) {
+        uint16_t const addr = static_cast<uint16_t>(start + i);
+        std::shared_ptr<MemPage> & page = mem_pages[addr >> MemPage::BITS];
+        if(page == nullptr) {
+            page = std::make_shared<MemPage>();
+        }
+        page->values[addr & (MemPage::SIZE - 1)] = values[i];
+        mem_lines.set(addr, lines[i]);
+    }
+}
+
+MachineState::MachineState(void) : reset_pc(RESET_PC), pc(0), ir(0), psr(0), mcr(0), cc_result(0), cc_pending(false),
+    decoded_ir(nullptr), ssp(0), interrupt_check(true), ignore_privilege(false), first_init(true)
 {
+    mmio.fill({ nullptr, { IDevice::ignoreRead, IDevice::ignoreWrite } });
     reinitialize();
 
-    registerDeviceReg(PSR, std::make_shared<RWReg>(PSR));
-    registerDeviceReg(MCR, std::make_shared<RWReg>(MCR));
+    registerDeviceReg(PSR, std::make_shared<StateReg>(*this, PSR, &MachineState::readPSR, &MachineState::writePSR));
+    registerDeviceReg(MCR, std::make_shared<StateReg>(*this, MCR, &MachineState::readMCR, &MachineState::writeMCR));
 }
 
 void MachineState::reinitialize(void)
@@ -21,55 +100,214 @@ void MachineState::reinitialize(void)
     reset_pc = RESET_PC;
     first_init = true;
 
-    mem.clear();
-    mem.resize(USER_END - SYSTEM_START + 1);
+    static std::shared_ptr<MemPage> const zero_page = sharePage(std::make_shared<MemPage>(), &MemPage::values);
+
+    uint32_t const mem_size = USER_END - SYSTEM_START + 1;
+    mem_pages.assign(mem_size / MemPage::SIZE, zero_page);
+    mem_lines.clear();
+    stringz_cells.assign(mem_size, false);
+    mem_watch.clear();
+    mem_watch.resize(mem_size / MemPage::SIZE);
+    code_writes.clear();
+    watched_accesses.clear();
 
     rf.clear();
     rf.resize(16);
 }
 
+PMachineSnapshot MachineState::snapshot(std::vector<uint16_t> const & stack_trace) const
+{
+    std::shared_ptr<MachineSnapshot> snapshot = std::make_shared<MachineSnapshot>();
+    snapshot->mem_pages = mem_pages;
+    snapshot->mem_lines = mem_lines;
+    snapshot->stringz_cells = stringz_cells;
+    snapshot->rf = rf;
+    for(PIDevice const & device : mmio_devices) {
+        snapshot->devices.push_back(device->saveState());
+    }
+    snapshot->reset_pc = reset_pc;
+    snapshot->pc = pc;
+    snapshot->ir = ir;
+    snapshot->psr = readPSR();
+    snapshot->mcr = mcr;
+    snapshot->ssp = ssp;
+    snapshot->pending_interrupts = pending_interrupts;
+    snapshot->first_init = first_init;
+    snapshot->func_trace = func_trace;
+    snapshot->stack_trace = stack_trace;
+    return snapshot;
+}
+
+void MachineState::restore(MachineSnapshot const & snapshot, std::vector<uint16_t> & stack_trace)
+{
+    mem_pages = snapshot.mem_pages;
+    mem_lines = snapshot.mem_lines;
+    stringz_cells = snapshot.stringz_cells;
+    rf = snapshot.rf;
+    for(size_t i = 0; i < mmio_devices.size() && i < snapshot.devices.size(); i += 1) {
+        if(snapshot.devices[i] != nullptr) {
+            mmio_devices[i]->restoreState(snapshot.devices[i]);
+        }
+    }
+    reset_pc = snapshot.reset_pc;
+    pc = snapshot.pc;
+    ir = snapshot.ir;
+    psr = snapshot.psr;
+    mcr = snapshot.mcr;
+    cc_pending = false;
+    decoded_ir = nullptr;
+    ssp = snapshot.ssp;
+    pending_interrupts = snapshot.pending_interrupts;
+    interrupt_check = true;
+    first_init = snapshot.first_init;
+    func_trace = snapshot.func_trace;
+    stack_trace = snapshot.stack_trace;
+
+    pending_callbacks.clear();
+    code_writes.clear();
+    watched_accesses.clear();
+}
+
+void MachineState::loadImage(MemImage const & image)
+{
+    for(MemImage::Block const & block : image.blocks) {
+        uint32_t const end = static_cast<uint32_t>(block.start) + block.size;
+        for(uint32_t addr = block.start; addr < end;) {
+            uint32_t const offset = addr & (MemPage::SIZE - 1);
+            uint32_t const count = std::min<uint32_t>(MemPage::SIZE - offset, end - addr);
+            std::shared_ptr<MemPage> const & image_page = image.mem_pages[addr >> MemPage::BITS];
+            std::shared_ptr<MemPage> & page = mem_pages[addr >> MemPage::BITS];
+            if(count == MemPage::SIZE) {
+                page = image_page;
+            } else {
+                if(page->shared || page.use_count() != 1) {
+                    page = std::make_shared<MemPage>(*page);
+                    page->shared = false;
+                }
+                std::memcpy(page->values + offset, image_page->values + offset, count * sizeof(page->values[0]));
+            }
+
+            // Translated code from these locations is stale, as it would be after a store.
+            if(mem_watch[addr >> MemPage::BITS] != nullptr) {
+                for(uint32_t i = addr; i < addr + count; i += 1) {
+                    if((readWatch(i) & WATCH_CODE) != 0) {
+                        writableWatch(i) &= static_cast<uint8_t>(~WATCH_CODE);
+                        code_writes.push_back(i);
+                    }
+                }
+            }
+            addr += count;
+        }
+
+        mem_lines.copy(image.mem_lines, block.start, block.size);
+        for(uint32_t addr = block.start; addr < end; addr += 1) {
+            stringz_cells[addr] = image.mem_lines.get(addr).length() == 1;
+        }
+    }
+}
+
+void MachineState::sharePages(void)
+{
+    // Pages still shared with a snapshot are left as they are.
+    for(std::shared_ptr<MemPage> & page : mem_pages) {
+        if(! page->shared && page.use_count() == 1) {
+            page = sharePage(page, &MemPage::values);
+        }
+    }
+    mem_lines.share();
+}
+
 void MachineState::setIgnorePrivilege(bool ignore_privilege) { this->ignore_privilege = ignore_privilege; }
 bool MachineState::getIgnorePrivilege(void) const { return ignore_privilege; }
 
 std::pair<uint16_t, PIMicroOp> MachineState::readMem(uint16_t addr) const
 {
     if(MMIO_START <= addr && addr <= MMIO_END) {
-        auto search = mmio.find(addr);
-        if(search != mmio.end()) {
-            return search->second->read(addr);
-        } else {
-            return std::make_pair(0x0000, nullptr);
-        }
+        MMIOEntry const & entry = mmio[addr - MMIO_START];
+        return entry.handlers.read(entry.device, addr);
     } else {
-        return std::make_pair(mem[addr].getValue(), nullptr);
+        return std::make_pair(memValue(addr), nullptr);
+    }
+}
+
+void MachineState::readMemRange(uint16_t start, uint16_t * values, uint32_t count) const
+{
+    uint32_t addr = start;
+    while(count != 0) {
+        addr &= 0xFFFF;
+        if(MMIO_START <= addr && addr <= MMIO_END) {
+            IDevice const * device = mmio[addr - MMIO_START].device;
+            *values = device != nullptr ? device->peek(static_cast<uint16_t>(addr)) : 0x0000;
+            values += 1;
+            addr += 1;
+            count -= 1;
+            continue;
+        }
+
+        // Whole runs of a page are copied at once.
+        uint32_t offset = addr & (MemPage::SIZE - 1);
+        uint32_t run = std::min<uint32_t>(count, MemPage::SIZE - offset);
+        std::memcpy(values, &mem_pages[addr >> MemPage::BITS]->values[offset], run * sizeof(uint16_t));
+        values += run;
+        addr += run;
+        count -= run;
     }
 }
 
 PIMicroOp MachineState::writeMem(uint16_t addr, uint16_t value)
 {
     if(MMIO_START <= addr && addr <= MMIO_END) {
-        auto search = mmio.find(addr);
-        if(search != mmio.end()) {
-            return search->second->write(addr, value);
-        }
+        MMIOEntry const & entry = mmio[addr - MMIO_START];
+        return entry.handlers.write(entry.device, addr, value);
     } else {
-        mem[addr].setValue(value);
-        // change line with new character if we are storing an ascii value to a line that's part of a .stringz
-        if (value <= 127 && getMemLine(addr).length() == 1) {
-            char val_char = value;
-            std::string val_ascii_to_string;
-            val_ascii_to_string += (char)value;
-            setMemLine(addr, val_ascii_to_string);
+        std::shared_ptr<MemPage> & page = mem_pages[addr >> MemPage::BITS];
+        if(page->shared || page.use_count() != 1) {
+            page = std::make_shared<MemPage>(*page);
+            page->shared = false;
+        }
+        uint16_t & cell = page->values[addr & (MemPage::SIZE - 1)];
+        // A .STRINGZ cell goes on showing the last ASCII character stored in it while it holds anything else, so
+        // that character is only written into its line once there is no other record of it.
+        if(value > 127 && cell <= 127 && stringz_cells[addr]) {
+            mem_lines.set(addr, std::string(1, static_cast<char>(cell)));
+        }
+        cell = value;
+        uint8_t watch = readWatch(addr);
+        if(watch != 0) {
+            if((watch & WATCH_CODE) != 0) {
+                writableWatch(addr) &= static_cast<uint8_t>(~WATCH_CODE);
+                code_writes.push_back(addr);
+            }
+            if((watch & WATCH_WRITE) != 0) {
+                watched_accesses.push_back(WatchedAccess{addr, true});
+            }
         }
     }
 
     return nullptr;
 }
 
+void MachineState::clearAccessWatches(void)
+{
+    for(std::unique_ptr<WatchPage> & page : mem_watch) {
+        if(page != nullptr) {
+            for(uint8_t & watch : page->watches) {
+                watch &= WATCH_CODE;
+            }
+        }
+    }
+    watched_accesses.clear();
+}
+
 std::string MachineState::getMemLine(uint16_t addr) const
 {
     if(addr < MMIO_START) {
-        return mem[addr].getLine();
+        // A .STRINGZ cell shows the ASCII character stored in it, if there is one, and otherwise its line, which
+        // writeMem keeps as the last one there was.
+        if(stringz_cells[addr] && memValue(addr) <= 127) {
+            return std::string(1, static_cast<char>(memValue(addr)));
+        }
+        return mem_lines.get(addr);
     }
 
     return "";
@@ -78,13 +316,19 @@ std::string MachineState::getMemLine(uint16_t addr) const
 void MachineState::setMemLine(uint16_t addr, std::string const & value)
 {
     if(addr < MMIO_START) {
-        mem[addr].setLine(value);
+        mem_lines.set(addr, value);
+        stringz_cells[addr] = value.length() == 1;
     }
 }
 
 void MachineState::registerDeviceReg(uint16_t mem_addr, PIDevice device)
 {
-    mmio[mem_addr] = device;
+    if(mem_addr < MMIO_START) { return; }
+
+    if(std::find(mmio_devices.begin(), mmio_devices.end(), device) == mmio_devices.end()) {
+        mmio_devices.push_back(device);
+    }
+    mmio[mem_addr - MMIO_START] = { device.get(), device->getRegHandlers(mem_addr) };
 }
 
 InterruptType MachineState::peekInterrupt(void) const
@@ -104,6 +348,7 @@ InterruptType MachineState::dequeueInterrupt(void)
 
     InterruptType type = pending_interrupts.front();
     pending_interrupts.pop();
+    interrupt_check = interrupt_check || pending_interrupts.size() != 0;
     return type;
 }
 
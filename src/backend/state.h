@@ -4,33 +4,82 @@
 #ifndef STATE_H
 #define STATE_H
 
+#include <array>
+#include <memory>
 #include <queue>
 #include <stack>
 #include <string>
 #include <vector>
-#include <unordered_map>
 #include <utility>
 
 #include "aliases.h"
 #include "callback.h"
 #include "device.h"
+#include "device_regs.h"
 #include "func_type.h"
 #include "intex.h"
 #include "mem.h"
+#include "uop.h"
 
 namespace lc3
 {
 namespace core
 {
     class IEvent;
-    using PIEvent = std::shared_ptr<IEvent>;
+    using PIEvent = std::unique_ptr<IEvent>;
+
+    // A copy of a machine: its memory and memory lines, registers, device state, and subroutine trace.  Only machines
+    // can look inside, so it is handed around as an opaque handle.
+    struct MachineSnapshot;
+    using PMachineSnapshot = std::shared_ptr<MachineSnapshot const>;
+
+    // Blocks of memory values and their lines, prepared once and then loaded into any number of machines, such as
+    // the OS.  Machines share the pages that a block covers completely with the image until they write to them.
+    class MemImage
+    {
+    public:
+        MemImage(void);
+
+        // Blocks must not overlap each other or the device register page.
+        void addBlock(uint16_t start, uint16_t const * values, char const * const * lines, uint32_t size);
+
+    private:
+        friend class MachineState;
+
+        struct Block
+        {
+            uint16_t start;
+            uint32_t size;
+        };
+
+        std::vector<Block> blocks;
+        // Only pages that blocks cover are present.
+        std::vector<std::shared_ptr<MemPage>> mem_pages;
+        MemLineTable mem_lines;
+    };
 
     class MachineState
     {
     public:
         MachineState(void);
+        // The device registers for PSR and MCR refer back to the state they were created for.
+        MachineState(MachineState const &) = delete;
+        MachineState & operator=(MachineState const &) = delete;
 
         void reinitialize(void);
+        // Taking a snapshot only shares the memory pages, which are copied when either side first writes to them, so
+        // both taking and restoring one cost about the same as copying the registers.  A snapshot can be restored
+        // into any machine with the same devices.  Whether privilege is ignored and which addresses are watched are
+        // settings rather than machine state, and are left alone.  The simulator's stack trace, the address each entry
+        // of the subroutine trace was entered from, is saved and restored alongside the subroutine trace.
+        PMachineSnapshot snapshot(std::vector<uint16_t> const & stack_trace) const;
+        void restore(MachineSnapshot const & snapshot, std::vector<uint16_t> & stack_trace);
+        // Copies the blocks of an image into memory, a page at a time, as loading the same values and lines one
+        // location at a time would.
+        void loadImage(MemImage const & image);
+        // Moves the memory pages and memory line pages only this machine holds into the pools shared by every machine,
+        // where they are replaced by any identical page another machine already put there.
+        void sharePages(void);
         bool getIgnorePrivilege(void) const;
         void setIgnorePrivilege(bool ignore);
 
@@ -42,31 +91,61 @@ namespace core
         uint16_t readIR(void) const { return ir; }
         void writeIR(uint16_t value) { ir = value; }
 
-        PIInstruction readDecodedIR(void) const { return decoded_ir; }
-        void writeDecodedIR(PIInstruction value) { decoded_ir = value; }
+        DecodedInstruction const * readDecodedIR(void) const { return decoded_ir; }
+        void writeDecodedIR(DecodedInstruction const * value) { decoded_ir = value; }
 
         uint16_t readSSP(void) const { return ssp; }
         void writeSSP(uint16_t value) { ssp = value; }
 
-        uint16_t readPSR(void) const { return std::get<0>(readMem(PSR)); }
-        void writePSR(uint16_t value) { writeMem(PSR, value); }
+        uint16_t readPSR(void) const { return (psr & 0xFFF8) | readCC(); }
+        void writePSR(uint16_t value)
+        {
+            if(((psr ^ value) & 0x0700) != 0) { interrupt_check = true; }
+            psr = value;
+            cc_pending = false;
+        }
 
-        uint16_t readMCR(void) const { return std::get<0>(readMem(MCR)); }
-        void writeMCR(uint16_t value) { writeMem(MCR, value); }
+        // Condition codes, i.e. PSR[2:0].  Instructions only record the result that sets them, which is turned into
+        // NZP bits when something reads them.
+        uint16_t readCC(void) const
+        {
+            if(! cc_pending) { return psr & 0x0007; }
+            return (cc_result & 0x8000) != 0 ? 0x0004 : (cc_result == 0 ? 0x0002 : 0x0001);
+        }
+        void writeCC(uint16_t value) { psr = (psr & 0xFFF8) | (value & 0x0007); cc_pending = false; }
+        void updateCC(uint16_t result) { cc_result = result; cc_pending = true; }
+
+        uint16_t readMCR(void) const { return mcr; }
+        void writeMCR(uint16_t value) { mcr = value; }
 
         uint16_t readReg(uint16_t id) const { return rf[id]; }
         void writeReg(uint16_t id, uint16_t value) { rf[id] = value; }
 
         std::pair<uint16_t, PIMicroOp> readMem(uint16_t addr) const;
+        // Reads count locations from start on, wrapping around at the end of memory, as readMem would one at a time,
+        // except that device registers are peeked at, without the effects a read has on the devices and the simulator.
+        void readMemRange(uint16_t start, uint16_t * values, uint32_t count) const;
+        // A load made by an instruction, which unlike fetches and other reads is seen by read watches.
+        std::pair<uint16_t, PIMicroOp> loadMem(uint16_t addr)
+        {
+            if(addr < MMIO_START && (readWatch(addr) & WATCH_READ) != 0) {
+                watched_accesses.push_back(WatchedAccess{addr, false});
+            }
+            return readMem(addr);
+        }
         PIMicroOp writeMem(uint16_t addr, uint16_t value);
         std::string getMemLine(uint16_t addr) const;
         void setMemLine(uint16_t addr, std::string const & value);
 
         void registerDeviceReg(uint16_t mem_addr, PIDevice device);
 
-        void enqueueInterrupt(InterruptType type) { pending_interrupts.push(type); }
+        void enqueueInterrupt(InterruptType type) { pending_interrupts.push(type); interrupt_check = true; }
         InterruptType peekInterrupt(void) const;
         InterruptType dequeueInterrupt(void);
+        // Whether the pending interrupts or the priority level have changed since the last interrupt check, i.e.
+        // whether another check could have a different outcome.
+        bool needsInterruptCheck(void) const { return interrupt_check; }
+        void completeInterruptCheck(void) { interrupt_check = false; }
 
 
         bool isFirstInit(void) const { return first_init; }
@@ -80,15 +159,66 @@ namespace core
         void clearPendingCallbacks(void) { pending_callbacks.clear(); }
         void addPendingCallback(CallbackType type) { pending_callbacks.push_back(type); }
 
+        MicroOpArena & getMicroOpArena(void) const { return uop_arena; }
+
+        // Translated code watches the addresses it was built from, and stores to them are recorded so that it can be
+        // invalidated.
+        void setCodeWatch(uint16_t addr, bool watch)
+        {
+            if(watch) {
+                writableWatch(addr) |= WATCH_CODE;
+            } else if(readWatch(addr) != 0) {
+                writableWatch(addr) &= static_cast<uint8_t>(~WATCH_CODE);
+            }
+        }
+        std::vector<uint16_t> const & getCodeWrites(void) const { return code_writes; }
+        void clearCodeWrites(void) { code_writes.clear(); }
+
+        // Watchpoints watch loads and stores to addresses outside the device register page, which are recorded in
+        // the order they were made.
+        struct WatchedAccess
+        {
+            uint16_t addr;
+            bool write;
+        };
+        void addAccessWatch(uint16_t addr, bool read, bool write)
+        {
+            writableWatch(addr) |= static_cast<uint8_t>((read ? WATCH_READ : 0) | (write ? WATCH_WRITE : 0));
+        }
+        void clearAccessWatches(void);
+        std::vector<WatchedAccess> const & getWatchedAccesses(void) const { return watched_accesses; }
+        void clearWatchedAccesses(void) { watched_accesses.clear(); }
+
     private:
         // Hardware state.
-        std::vector<MemLocation> mem;
+        // Memory values are kept in pages, with their source lines in a separate table.  Pages start out as the
+        // shared zero page, and a store to a page that is shared, either with a snapshot or with other machines,
+        // first replaces it with a private copy, so a machine only holds the pages its program changed.  The lines of
+        // .STRINGZ cells, i.e. lines that are a single character, show the character currently stored there; they are
+        // marked when the line is set and rendered when asked for, so that stores never have to look at lines.
+        std::vector<std::shared_ptr<MemPage>> mem_pages;
+        MemLineTable mem_lines;
+        std::vector<bool> stringz_cells;
         std::vector<uint16_t> rf;
-        std::unordered_map<uint16_t, PIDevice> mmio;
+        // Accesses to the device page go straight to the handlers registered for each address.  The devices are owned
+        // by mmio_devices; unmapped addresses have no device and ignore accesses.
+        struct MMIOEntry
+        {
+            IDevice * device;
+            IDevice::RegHandlers handlers;
+        };
+        std::array<MMIOEntry, MMIO_END - MMIO_START + 1> mmio;
+        std::vector<PIDevice> mmio_devices;
         uint16_t reset_pc, pc, ir;
-        PIInstruction decoded_ir;
+        // PSR and MCR are kept here rather than with the other device registers, and are only exposed in the device
+        // register page.  While cc_pending is set, the condition codes in psr are stale and follow from cc_result.
+        uint16_t psr, mcr;
+        uint16_t cc_result;
+        bool cc_pending;
+        DecodedInstruction const * decoded_ir;
         uint16_t ssp;
         std::queue<InterruptType> pending_interrupts;
+        bool interrupt_check;
 
         // Simulation state.
         bool ignore_privilege;
@@ -96,6 +226,39 @@ namespace core
 
         std::stack<FuncType> func_trace;
         std::vector<CallbackType> pending_callbacks;
+        // Which of translated code, loads, and stores are watched at each address, so that an access to an address
+        // nothing watches costs a single test.  They are kept by memory page, and pages where nothing was ever
+        // watched have none.
+        enum : uint8_t { WATCH_CODE = 1, WATCH_READ = 2, WATCH_WRITE = 4 };
+        struct WatchPage
+        {
+            uint8_t watches[MemPage::SIZE];
+        };
+        std::vector<std::unique_ptr<WatchPage>> mem_watch;
+        std::vector<uint16_t> code_writes;
+        std::vector<WatchedAccess> watched_accesses;
+
+        uint16_t memValue(uint16_t addr) const
+        {
+            return mem_pages[addr >> MemPage::BITS]->values[addr & (MemPage::SIZE - 1)];
+        }
+        uint8_t readWatch(uint16_t addr) const
+        {
+            WatchPage const * page = mem_watch[addr >> MemPage::BITS].get();
+            return page != nullptr ? page->watches[addr & (MemPage::SIZE - 1)] : 0;
+        }
+        uint8_t & writableWatch(uint16_t addr)
+        {
+            std::unique_ptr<WatchPage> & page = mem_watch[addr >> MemPage::BITS];
+            if(page == nullptr) {
+                page.reset(new WatchPage());
+            }
+            return page->watches[addr & (MemPage::SIZE - 1)];
+        }
+
+        // Micro-ops are scratch space for executing an instruction rather than machine state, so they may be built
+        // from a const state.
+        mutable MicroOpArena uop_arena;
     };
 };
 };
@@ -0,0 +1,389 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include "translator.h"
+
+#include "decoder.h"
+#include "device_regs.h"
+#include "isa.h"
+
+using namespace lc3::core;
+using namespace lc3::core::sim;
+
+namespace
+{
+    PIMicroOp chainMicroOps(PIMicroOp first, PIMicroOp second)
+    {
+        if(first == nullptr) {
+            return second;
+        }
+
+        if(second != nullptr) {
+            first->insert(second);
+        }
+        return first;
+    }
+
+    // Anything that can raise an exception falls back to the micro-op chain before touching any state, so exception
+    // handling is shared with the cycle-timed engine.
+    PIMicroOp executeMicroOpChain(MachineState & state, TranslatedOp const & op)
+    {
+        return op.decoded->inst->buildMicroOps(state, *op.decoded);
+    }
+
+    PIMicroOp executeBR(MachineState & state, TranslatedOp const & op)
+    {
+        if((op.decoded->dr & state.readCC()) != 0) {
+            state.writePC(op.addr);
+        }
+        return nullptr;
+    }
+
+    PIMicroOp executeADDReg(MachineState & state, TranslatedOp const & op)
+    {
+        uint16_t value = state.readReg(op.decoded->sr1) + state.readReg(op.decoded->sr2);
+        state.writeReg(op.decoded->dr, value);
+        state.updateCC(value);
+        return nullptr;
+    }
+
+    PIMicroOp executeADDImm(MachineState & state, TranslatedOp const & op)
+    {
+        uint16_t value = state.readReg(op.decoded->sr1) + op.decoded->imm5;
+        state.writeReg(op.decoded->dr, value);
+        state.updateCC(value);
+        return nullptr;
+    }
+
+    PIMicroOp executeANDReg(MachineState & state, TranslatedOp const & op)
+    {
+        uint16_t value = state.readReg(op.decoded->sr1) & state.readReg(op.decoded->sr2);
+        state.writeReg(op.decoded->dr, value);
+        state.updateCC(value);
+        return nullptr;
+    }
+
+    PIMicroOp executeANDImm(MachineState & state, TranslatedOp const & op)
+    {
+        uint16_t value = state.readReg(op.decoded->sr1) & op.decoded->imm5;
+        state.writeReg(op.decoded->dr, value);
+        state.updateCC(value);
+        return nullptr;
+    }
+
+    PIMicroOp executeLoad(MachineState & state, TranslatedOp const & op, uint16_t addr, bool indirect)
+    {
+        if(isAccessViolation(addr, state)) {
+            return executeMicroOpChain(state, op);
+        }
+
+        std::pair<uint16_t, PIMicroOp> pointer(addr, nullptr);
+        if(indirect) {
+            pointer = state.loadMem(addr);
+            if(isAccessViolation(std::get<0>(pointer), state)) {
+                return executeMicroOpChain(state, op);
+            }
+        }
+
+        std::pair<uint16_t, PIMicroOp> result = state.loadMem(std::get<0>(pointer));
+        uint16_t value = std::get<0>(result);
+        state.writeReg(op.decoded->dr, value);
+        state.updateCC(value);
+        return chainMicroOps(std::get<1>(pointer), std::get<1>(result));
+    }
+
+    PIMicroOp executeLD(MachineState & state, TranslatedOp const & op)
+    {
+        return executeLoad(state, op, op.addr, false);
+    }
+
+    PIMicroOp executeLDI(MachineState & state, TranslatedOp const & op)
+    {
+        return executeLoad(state, op, op.addr, true);
+    }
+
+    PIMicroOp executeLDR(MachineState & state, TranslatedOp const & op)
+    {
+        return executeLoad(state, op, state.readReg(op.decoded->sr1) + op.decoded->offset6, false);
+    }
+
+    PIMicroOp executeStore(MachineState & state, TranslatedOp const & op, uint16_t addr, bool indirect)
+    {
+        if(isAccessViolation(addr, state)) {
+            return executeMicroOpChain(state, op);
+        }
+
+        std::pair<uint16_t, PIMicroOp> pointer(addr, nullptr);
+        if(indirect) {
+            pointer = state.loadMem(addr);
+            if(isAccessViolation(std::get<0>(pointer), state)) {
+                return executeMicroOpChain(state, op);
+            }
+        }
+
+        PIMicroOp write_op = state.writeMem(std::get<0>(pointer), state.readReg(op.decoded->dr));
+        return chainMicroOps(std::get<1>(pointer), write_op);
+    }
+
+    PIMicroOp executeST(MachineState & state, TranslatedOp const & op)
+    {
+        return executeStore(state, op, op.addr, false);
+    }
+
+    PIMicroOp executeSTI(MachineState & state, TranslatedOp const & op)
+    {
+        return executeStore(state, op, op.addr, true);
+    }
+
+    PIMicroOp executeSTR(MachineState & state, TranslatedOp const & op)
+    {
+        return executeStore(state, op, state.readReg(op.decoded->sr1) + op.decoded->offset6, false);
+    }
+
+    PIMicroOp executeJSR(MachineState & state, TranslatedOp const & op)
+    {
+        uint16_t target = op.decoded->pc_relative ? op.addr : state.readReg(op.decoded->sr1);
+        state.writePC(target);
+        state.writeReg(7, op.pc + 1);
+        state.addPendingCallback(CallbackType::SUB_ENTER);
+        state.pushFuncTraceType(FuncType::SUBROUTINE);
+        return nullptr;
+    }
+
+    PIMicroOp executeNOT(MachineState & state, TranslatedOp const & op)
+    {
+        uint16_t value = ~state.readReg(op.decoded->sr1);
+        state.writeReg(op.decoded->dr, value);
+        state.updateCC(value);
+        return nullptr;
+    }
+
+    PIMicroOp executeJMP(MachineState & state, TranslatedOp const & op)
+    {
+        state.writePC(state.readReg(op.decoded->sr1));
+        if(op.decoded->sr1 == 7 && state.peekFuncTraceType() == FuncType::SUBROUTINE) {
+            state.addPendingCallback(CallbackType::SUB_EXIT);
+            state.popFuncTraceType();
+        }
+        return nullptr;
+    }
+
+    PIMicroOp executeLEA(MachineState & state, TranslatedOp const & op)
+    {
+        state.writeReg(op.decoded->dr, op.addr);
+        return nullptr;
+    }
+
+    // ADD followed by a conditional branch on its result, as in a counted loop.
+    bool executeADDBR(MachineState & state, TranslatedOp const & op, TranslatedOp const & next)
+    {
+        uint16_t src2 = op.decoded->imm_mode ? op.decoded->imm5 : state.readReg(op.decoded->sr2);
+        uint16_t value = state.readReg(op.decoded->sr1) + src2;
+        state.writeReg(op.decoded->dr, value);
+        state.updateCC(value);
+
+        uint16_t cc = (value & 0x8000) != 0 ? 0x4 : (value == 0 ? 0x2 : 0x1);
+        state.writePC((next.decoded->dr & cc) != 0 ? next.addr : next.pc + 1);
+        return true;
+    }
+
+    // LDR followed by an ADD, as in a loop over an array.  The condition codes from the load are overwritten by the
+    // ADD before anything can observe them.
+    bool executeLDRADD(MachineState & state, TranslatedOp const & op, TranslatedOp const & next)
+    {
+        uint16_t addr = state.readReg(op.decoded->sr1) + op.decoded->offset6;
+        if(addr >= MMIO_START || isAccessViolation(addr, state)) {
+            return false;
+        }
+        state.writeReg(op.decoded->dr, std::get<0>(state.loadMem(addr)));
+
+        uint16_t src2 = next.decoded->imm_mode ? next.decoded->imm5 : state.readReg(next.decoded->sr2);
+        uint16_t value = state.readReg(next.decoded->sr1) + src2;
+        state.writeReg(next.decoded->dr, value);
+        state.updateCC(value);
+        state.writePC(next.pc + 1);
+        return true;
+    }
+
+    bool isTerminator(DecodedInstruction const & decoded)
+    {
+        switch(decoded.opcode) {
+            case 0x0: case 0x4: case 0x8: case 0xc: case 0xf: return true;
+            default: return false;
+        }
+    }
+}
+
+TranslatedOp lc3::core::sim::translateInstruction(uint16_t pc, DecodedInstruction const * decoded)
+{
+    TranslatedOp op;
+    op.decoded = decoded;
+    op.pc = pc;
+    op.addr = 0;
+    op.fused = nullptr;
+
+    switch(decoded->opcode) {
+        case 0x0: op.handler = executeBR; op.addr = pc + 1 + decoded->pcoffset9; break;
+        case 0x1: op.handler = decoded->imm_mode ? executeADDImm : executeADDReg; break;
+        case 0x2: op.handler = executeLD; op.addr = pc + 1 + decoded->pcoffset9; break;
+        case 0x3: op.handler = executeST; op.addr = pc + 1 + decoded->pcoffset9; break;
+        case 0x4: op.handler = executeJSR; op.addr = pc + 1 + decoded->pcoffset11; break;
+        case 0x5: op.handler = decoded->imm_mode ? executeANDImm : executeANDReg; break;
+        case 0x6: op.handler = executeLDR; break;
+        case 0x7: op.handler = executeSTR; break;
+        case 0x9: op.handler = executeNOT; break;
+        case 0xa: op.handler = executeLDI; op.addr = pc + 1 + decoded->pcoffset9; break;
+        case 0xb: op.handler = executeSTI; op.addr = pc + 1 + decoded->pcoffset9; break;
+        case 0xc: op.handler = executeJMP; break;
+        case 0xe: op.handler = executeLEA; op.addr = pc + 1 + decoded->pcoffset9; break;
+        default: op.handler = executeMicroOpChain; break;
+    }
+
+    return op;
+}
+
+BlockCache::BlockCache(void) : cur_block(nullptr), cur_op(0)
+{
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.invalidations = 0;
+}
+
+TranslatedOp const * BlockCache::lookup(uint16_t pc, MachineState & state)
+{
+    if(! state.getCodeWrites().empty()) {
+        invalidate(state);
+    }
+
+    if(cur_block != nullptr && cur_op < cur_block->ops.size() && cur_block->ops[cur_op].pc == pc) {
+        cur_op += 1;
+        return &cur_block->ops[cur_op - 1];
+    }
+
+    cur_block = nullptr;
+    if(pc >= MMIO_START) {
+        return nullptr;
+    }
+
+    auto search = blocks.find(pc);
+    if(search == blocks.end()) {
+        TranslatedBlock block = translate(pc, state);
+        if(block.ops.empty()) {
+            return nullptr;
+        }
+
+        stats.misses += 1;
+        for(uint32_t addr = block.start; addr <= block.end; addr += 1) {
+            state.setCodeWatch(static_cast<uint16_t>(addr), true);
+        }
+        search = blocks.emplace(pc, std::move(block)).first;
+    } else {
+        stats.hits += 1;
+    }
+
+    cur_block = &search->second;
+    cur_op = 1;
+    return &cur_block->ops[0];
+}
+
+TranslatedOp const * BlockCache::peekNext(void) const
+{
+    if(cur_block == nullptr || cur_op >= cur_block->ops.size()) {
+        return nullptr;
+    }
+
+    return &cur_block->ops[cur_op];
+}
+
+void BlockCache::flush(MachineState & state)
+{
+    for(auto const & block : blocks) {
+        for(uint32_t addr = block.second.start; addr <= block.second.end; addr += 1) {
+            state.setCodeWatch(static_cast<uint16_t>(addr), false);
+        }
+    }
+    blocks.clear();
+    state.clearCodeWrites();
+    cur_block = nullptr;
+}
+
+TranslatedBlock BlockCache::translate(uint16_t pc, MachineState const & state) const
+{
+    static Decoder const decoder;
+
+    TranslatedBlock block;
+    block.start = pc;
+    block.end = pc;
+
+    uint32_t addr = pc;
+    while(addr < MMIO_START && block.ops.size() < MAX_BLOCK_LENGTH) {
+        DecodedInstruction const * decoded = decoder.decode(std::get<0>(state.readMem(static_cast<uint16_t>(addr))));
+        if(decoded == nullptr) {
+            break;
+        }
+
+        block.ops.push_back(translateInstruction(static_cast<uint16_t>(addr), decoded));
+        block.end = static_cast<uint16_t>(addr);
+        if(isTerminator(*decoded)) {
+            break;
+        }
+        addr += 1;
+    }
+
+    // Pair up common sequences into superinstructions.
+    for(uint32_t i = 0; i + 1 < block.ops.size(); i += 1) {
+        DecodedInstruction const & first = *block.ops[i].decoded;
+        DecodedInstruction const & second = *block.ops[i + 1].decoded;
+        if(first.opcode == 0x1 && second.opcode == 0x0 && second.dr != 0) {
+            block.ops[i].fused = executeADDBR;
+        } else if(first.opcode == 0x6 && second.opcode == 0x1) {
+            block.ops[i].fused = executeLDRADD;
+        }
+    }
+
+    return block;
+}
+
+void BlockCache::invalidate(MachineState & state)
+{
+    std::vector<uint16_t> const & writes = state.getCodeWrites();
+    std::vector<std::pair<uint16_t, uint16_t>> ranges;
+    for(auto it = blocks.begin(); it != blocks.end();) {
+        bool stale = false;
+        for(uint16_t addr : writes) {
+            if(it->second.start <= addr && addr <= it->second.end) {
+                stale = true;
+                break;
+            }
+        }
+
+        if(stale) {
+            if(cur_block == &it->second) {
+                cur_block = nullptr;
+            }
+            ranges.emplace_back(it->second.start, it->second.end);
+            it = blocks.erase(it);
+            stats.invalidations += 1;
+        } else {
+            ++it;
+        }
+    }
+    state.clearCodeWrites();
+
+    // Stop watching the invalidated ranges, except where they overlap a block that is still cached.
+    for(auto const & range : ranges) {
+        for(uint32_t addr = range.first; addr <= range.second; addr += 1) {
+            state.setCodeWatch(static_cast<uint16_t>(addr), false);
+        }
+    }
+    for(auto const & block : blocks) {
+        for(auto const & range : ranges) {
+            if(block.second.start <= range.second && range.first <= block.second.end) {
+                for(uint32_t addr = block.second.start; addr <= block.second.end; addr += 1) {
+                    state.setCodeWatch(static_cast<uint16_t>(addr), true);
+                }
+                break;
+            }
+        }
+    }
+}
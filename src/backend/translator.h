@@ -0,0 +1,89 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#ifndef TRANSLATOR_H
+#define TRANSLATOR_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "aliases.h"
+#include "isa_abstract.h"
+#include "state.h"
+
+namespace lc3
+{
+namespace core
+{
+namespace sim
+{
+    // A single instruction with its handler and operands bound at translation time.
+    struct TranslatedOp
+    {
+        // Executes the instruction and returns any micro-ops that still have to run (device side effects or an
+        // exception sequence).  PC has already been advanced past the instruction.
+        using Handler = PIMicroOp (*)(MachineState & state, TranslatedOp const & op);
+        // Executes this instruction and the one after it as a unit.  Returns false, without changing any state, if
+        // the pair can't be run that way this time around.
+        using FusedHandler = bool (*)(MachineState & state, TranslatedOp const & op, TranslatedOp const & next);
+
+        DecodedInstruction const * decoded;
+        uint16_t pc;
+        uint16_t addr;          // PC-relative target, pre-computed for instructions that have one
+        Handler handler;
+        FusedHandler fused;
+    };
+
+    // A straight-line run of instructions ending in a control flow instruction.
+    struct TranslatedBlock
+    {
+        uint16_t start, end;
+        std::vector<TranslatedOp> ops;
+    };
+
+    struct BlockCacheStats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t invalidations;
+    };
+
+    TranslatedOp translateInstruction(uint16_t pc, DecodedInstruction const * decoded);
+
+    class BlockCache
+    {
+    public:
+        BlockCache(void);
+
+        // Returns the op for the instruction at pc, continuing the current block or looking up (and translating, if
+        // needed) the block starting at pc.  Returns nullptr for code that can't be translated, i.e. illegal
+        // instructions and anything in the device register page.
+        TranslatedOp const * lookup(uint16_t pc, MachineState & state);
+        // The op after the last one returned by lookup, if it is in the same block.
+        TranslatedOp const * peekNext(void) const;
+        void advance(void) { cur_op += 1; }
+        // The block the last op returned by lookup belongs to, and whether that op was the first in the block.
+        TranslatedBlock const * getCurrentBlock(void) const { return cur_block; }
+        bool isAtBlockStart(void) const { return cur_block != nullptr && cur_op == 1; }
+        void flush(MachineState & state);
+
+        BlockCacheStats const & getStats(void) const { return stats; }
+
+        static constexpr uint32_t MAX_BLOCK_LENGTH = 32;
+
+    private:
+
+        std::unordered_map<uint16_t, TranslatedBlock> blocks;
+        TranslatedBlock const * cur_block;
+        uint32_t cur_op;
+        BlockCacheStats stats;
+
+        TranslatedBlock translate(uint16_t pc, MachineState const & state) const;
+        void invalidate(MachineState & state);
+    };
+};
+};
+};
+
+#endif
@@ -8,6 +8,34 @@
 
 using namespace lc3::core;
 
+void MicroOpArena::reset(void)
+{
+    for(IMicroOp * uop : uops) {
+        uop->~IMicroOp();
+    }
+    uops.clear();
+
+    block_id = 0;
+    block_offset = 0;
+}
+
+void * MicroOpArena::allocate(std::size_t size, std::size_t align)
+{
+    std::size_t offset = (block_offset + align - 1) & ~(align - 1);
+    if(block_id == blocks.size() || offset + size > BLOCK_SIZE) {
+        if(block_id < blocks.size()) {
+            ++block_id;
+        }
+        if(block_id == blocks.size()) {
+            blocks.emplace_back(new char[BLOCK_SIZE]);
+        }
+        offset = 0;
+    }
+
+    block_offset = offset + size;
+    return blocks[block_id].get() + offset;
+}
+
 PIMicroOp IMicroOp::insert(PIMicroOp new_next)
 {
     if(next == nullptr) {
@@ -34,12 +62,14 @@ std::string IMicroOp::regToString(uint16_t reg_id) const
 
 void FetchMicroOp::handleMicroOp(MachineState & state)
 {
+    MicroOpArena & arena = state.getMicroOpArena();
+
     if(isAccessViolation(state.readPC(), state)) {
-        PIMicroOp msg = std::make_shared<PrintMessageMicroOp>("illegal memory access (ACV)");
+        PIMicroOp msg = arena.make<PrintMessageMicroOp>("illegal memory access (ACV)");
         std::pair<PIMicroOp, PIMicroOp> handle_exception_chain = buildSystemModeEnter(INTEX_TABLE_START, 0x2,
-            lc3::utils::getBits(state.readPSR(), 10, 8));
-        PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::EX_ENTER);
-        PIMicroOp func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
+            lc3::utils::getBits(state.readPSR(), 10, 8), state);
+        PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::EX_ENTER);
+        PIMicroOp func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
 
         msg->insert(handle_exception_chain.first);
         handle_exception_chain.second->insert(callback);
@@ -60,17 +90,19 @@ std::string FetchMicroOp::toString(MachineState const & state) const
 
 void DecodeMicroOp::handleMicroOp(MachineState & state)
 {
-    lc3::optional<PIInstruction> inst = decoder.decode(state.readIR());
-    if(inst) {
-        insert((*inst)->buildMicroOps(state));
-        state.writeDecodedIR(*inst);
+    MicroOpArena & arena = state.getMicroOpArena();
+
+    DecodedInstruction const * decoded = decoder.decode(state.readIR());
+    if(decoded != nullptr) {
+        insert(decoded->inst->buildMicroOps(state, *decoded));
+        state.writeDecodedIR(decoded);
     } else {
-        PIMicroOp msg = std::make_shared<PrintMessageMicroOp>("unknown opcode");
-        PIMicroOp dec_pc = std::make_shared<PCAddImmMicroOp>(-1);
+        PIMicroOp msg = arena.make<PrintMessageMicroOp>("unknown opcode");
+        PIMicroOp dec_pc = arena.make<PCAddImmMicroOp>(-1);
         std::pair<PIMicroOp, PIMicroOp> handle_exception_chain = buildSystemModeEnter(INTEX_TABLE_START, 0x1,
-            lc3::utils::getBits(state.readPSR(), 10, 8));
-        PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::EX_ENTER);
-        PIMicroOp func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
+            lc3::utils::getBits(state.readPSR(), 10, 8), state);
+        PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::EX_ENTER);
+        PIMicroOp func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
 
         msg->insert(dec_pc);
         dec_pc->insert(handle_exception_chain.first);
@@ -83,10 +115,9 @@ void DecodeMicroOp::handleMicroOp(MachineState & state)
 
 std::string DecodeMicroOp::toString(MachineState const & state) const
 {
-    lc3::optional<PIInstruction> inst = decoder.decode(state.readIR());
-    if(inst) {
-        (*inst)->buildMicroOps(state);
-        return lc3::utils::ssprintf("dIR <= %s", (*inst)->toValueString().c_str());
+    DecodedInstruction const * decoded = decoder.decode(state.readIR());
+    if(decoded != nullptr) {
+        return lc3::utils::ssprintf("dIR <= %s", decoded->inst->toValueString(decoded->value).c_str());
     } else {
         return "dIR <= Illegal instruction";
     }
@@ -259,14 +290,16 @@ std::string RegNotMicroOp::toString(MachineState const & state) const
 
 void MemReadMicroOp::handleMicroOp(MachineState & state)
 {
+    MicroOpArena & arena = state.getMicroOpArena();
+
     uint16_t addr = state.readReg(addr_reg_id);
     if(isAccessViolation(addr, state)) {
-        PIMicroOp msg = std::make_shared<PrintMessageMicroOp>("illegal memory access (ACV)");
-        PIMicroOp dec_pc = std::make_shared<PCAddImmMicroOp>(-1);
+        PIMicroOp msg = arena.make<PrintMessageMicroOp>("illegal memory access (ACV)");
+        PIMicroOp dec_pc = arena.make<PCAddImmMicroOp>(-1);
         std::pair<PIMicroOp, PIMicroOp> handle_exception_chain = buildSystemModeEnter(INTEX_TABLE_START, 0x2,
-            lc3::utils::getBits(state.readPSR(), 10, 8));
-        PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::EX_ENTER);
-        PIMicroOp func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
+            lc3::utils::getBits(state.readPSR(), 10, 8), state);
+        PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::EX_ENTER);
+        PIMicroOp func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
 
         msg->insert(dec_pc);
         dec_pc->insert(handle_exception_chain.first);
@@ -275,7 +308,7 @@ void MemReadMicroOp::handleMicroOp(MachineState & state)
 
         next = msg;
     } else {
-        std::pair<uint16_t, PIMicroOp> read_result = state.readMem(addr);
+        std::pair<uint16_t, PIMicroOp> read_result = state.loadMem(addr);
 
         uint16_t value = std::get<0>(read_result);
         PIMicroOp op = std::get<1>(read_result);
@@ -297,14 +330,16 @@ std::string MemReadMicroOp::toString(MachineState const & state) const
 
 void MemWriteImmMicroOp::handleMicroOp(MachineState & state)
 {
+    MicroOpArena & arena = state.getMicroOpArena();
+
     uint16_t addr = state.readReg(addr_reg_id);
     if(isAccessViolation(addr, state)) {
-        PIMicroOp msg = std::make_shared<PrintMessageMicroOp>("illegal memory access (ACV)");
-        PIMicroOp dec_pc = std::make_shared<PCAddImmMicroOp>(-1);
+        PIMicroOp msg = arena.make<PrintMessageMicroOp>("illegal memory access (ACV)");
+        PIMicroOp dec_pc = arena.make<PCAddImmMicroOp>(-1);
         std::pair<PIMicroOp, PIMicroOp> handle_exception_chain = buildSystemModeEnter(INTEX_TABLE_START, 0x2,
-            lc3::utils::getBits(state.readPSR(), 10, 8));
-        PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::EX_ENTER);
-        PIMicroOp func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
+            lc3::utils::getBits(state.readPSR(), 10, 8), state);
+        PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::EX_ENTER);
+        PIMicroOp func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
 
         msg->insert(dec_pc);
         dec_pc->insert(handle_exception_chain.first);
@@ -329,14 +364,16 @@ std::string MemWriteImmMicroOp::toString(MachineState const & state) const
 
 void MemWriteRegMicroOp::handleMicroOp(MachineState & state)
 {
+    MicroOpArena & arena = state.getMicroOpArena();
+
     uint16_t addr = state.readReg(addr_reg_id);
     if(isAccessViolation(addr, state)) {
-        PIMicroOp msg = std::make_shared<PrintMessageMicroOp>("illegal memory access (ACV)");
-        PIMicroOp dec_pc = std::make_shared<PCAddImmMicroOp>(-1);
+        PIMicroOp msg = arena.make<PrintMessageMicroOp>("illegal memory access (ACV)");
+        PIMicroOp dec_pc = arena.make<PCAddImmMicroOp>(-1);
         std::pair<PIMicroOp, PIMicroOp> handle_exception_chain = buildSystemModeEnter(INTEX_TABLE_START, 0x2,
-            lc3::utils::getBits(state.readPSR(), 10, 8));
-        PIMicroOp callback = std::make_shared<CallbackMicroOp>(CallbackType::EX_ENTER);
-        PIMicroOp func_trace = std::make_shared<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
+            lc3::utils::getBits(state.readPSR(), 10, 8), state);
+        PIMicroOp callback = arena.make<CallbackMicroOp>(CallbackType::EX_ENTER);
+        PIMicroOp func_trace = arena.make<PushFuncTypeMicroOp>(FuncType::EXCEPTION);
 
         msg->insert(dec_pc);
         dec_pc->insert(handle_exception_chain.first);
@@ -362,15 +399,7 @@ std::string MemWriteRegMicroOp::toString(MachineState const & state) const
 
 void CCUpdateRegMicroOp::handleMicroOp(MachineState & state)
 {
-    uint16_t psr_value = state.readPSR();
-    char cc_char = getCCChar(state.readReg(reg_id));
-    if(cc_char == 'N') {
-        state.writePSR((psr_value & 0xFFF8) | 0x0004);
-    } else if(cc_char == 'Z') {
-        state.writePSR((psr_value & 0xFFF8) | 0x0002);
-    } else {
-        state.writePSR((psr_value & 0xFFF8) | 0x0001);
-    }
+    state.updateCC(state.readReg(reg_id));
 }
 
 std::string CCUpdateRegMicroOp::toString(MachineState const & state) const
@@ -413,7 +442,7 @@ void BranchMicroOp::handleMicroOp(MachineState & state)
 
 std::string BranchMicroOp::toString(MachineState const & state) const
 {
-    return lc3::utils::ssprintf("uBEN <= (%s):%s", msg.c_str(), pred(state) ? "true" : "false");
+    return lc3::utils::ssprintf("uBEN <= (%s):%s", msg, pred(state) ? "true" : "false");
 }
 
 PIMicroOp BranchMicroOp::insert(PIMicroOp new_next)
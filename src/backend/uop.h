@@ -4,8 +4,12 @@
 #ifndef UOP_H
 #define UOP_H
 
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <new>
+#include <utility>
+#include <vector>
 
 #include "aliases.h"
 #include "callback.h"
@@ -37,6 +41,31 @@ namespace core
         std::string regToString(uint16_t reg_id) const;
     };
 
+    // Owns the micro-ops built while processing an instruction.  Micro-ops are constructed in place in fixed-size
+    // blocks that are kept across reset(), so once the blocks have grown to fit the largest instruction no further
+    // heap allocations are made.
+    class MicroOpArena
+    {
+    public:
+        MicroOpArena(void) : block_id(0), block_offset(0) { }
+        MicroOpArena(MicroOpArena const &) = delete;
+        MicroOpArena & operator=(MicroOpArena const &) = delete;
+        ~MicroOpArena(void) { reset(); }
+
+        template<typename T, typename ... Args>
+        T * make(Args && ... args);
+        void reset(void);
+
+    private:
+        static constexpr std::size_t BLOCK_SIZE = 4096;
+
+        std::vector<std::unique_ptr<char[]>> blocks;
+        std::size_t block_id, block_offset;
+        std::vector<IMicroOp *> uops;
+
+        void * allocate(std::size_t size, std::size_t align);
+    };
+
     class FetchMicroOp : public IMicroOp
     {
     public:
@@ -291,7 +320,7 @@ namespace core
     public:
         using PredFunction = std::function<bool(MachineState const & state)>;
 
-        BranchMicroOp(PredFunction pred, std::string msg, PIMicroOp true_next, PIMicroOp false_next) :
+        BranchMicroOp(PredFunction pred, char const * msg, PIMicroOp true_next, PIMicroOp false_next) :
             pred(pred), msg(msg), true_next(true_next), false_next(false_next) { }
 
         virtual void handleMicroOp(MachineState & state) override;
@@ -300,7 +329,7 @@ namespace core
 
     private:
         PredFunction pred;
-        std::string msg;
+        char const * msg;
         PIMicroOp true_next, false_next;
     };
 
@@ -362,7 +391,7 @@ namespace core
     class GenericPopMicroOp : public IMicroOp
     {
     public:
-        GenericPopMicroOp(T & data, std::string const & name) : IMicroOp(), data(data), name(name) { }
+        GenericPopMicroOp(T & data, char const * name) : IMicroOp(), data(data), name(name) { }
 
         virtual void handleMicroOp(MachineState & state) override
         {
@@ -373,29 +402,40 @@ namespace core
         virtual std::string toString(MachineState const & state) const override
         {
             (void) state;
-            return lc3::utils::ssprintf("%s <= %s.removeTop()", name.c_str(), name.c_str());
+            return lc3::utils::ssprintf("%s <= %s.removeTop()", name, name);
         }
 
     private:
         T & data;
-        std::string name;
+        char const * name;
     };
 
     class PrintMessageMicroOp : public IMicroOp
     {
     public:
-        PrintMessageMicroOp(std::string const & msg) : IMicroOp(), msg(msg) { }
+        PrintMessageMicroOp(char const * msg) : IMicroOp(), msg(msg) { }
 
         virtual void handleMicroOp(MachineState & state) override;
         virtual std::string toString(MachineState const & state) const override;
 
     private:
-        std::string msg;
+        char const * msg;
     };
 
     bool isAccessViolation(uint16_t addr, MachineState const & state);
-    std::pair<PIMicroOp, PIMicroOp> buildSystemModeEnter(uint16_t table_start, uint8_t vec, uint8_t priority);
+    std::pair<PIMicroOp, PIMicroOp> buildSystemModeEnter(uint16_t table_start, uint8_t vec, uint8_t priority,
+        MachineState const & state);
 };
 };
 
+template<typename T, typename ... Args>
+T * lc3::core::MicroOpArena::make(Args && ... args)
+{
+    static_assert(sizeof(T) <= BLOCK_SIZE, "micro-op does not fit in arena block");
+
+    T * uop = new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    uops.push_back(uop);
+    return uop;
+}
+
 #endif
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace bench
+{
+    // How long fn takes to run.
+    template<typename Fn>
+    std::chrono::nanoseconds measure(Fn && fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    }
+
+    // Nanoseconds per item of count items that took elapsed in all.
+    inline double nsPer(std::chrono::nanoseconds elapsed, uint64_t count)
+    {
+        return static_cast<double>(elapsed.count()) / static_cast<double>(count);
+    }
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "bench.h"
+#include "inputter.h"
+#include "printer.h"
+#include "simulator.h"
+
+// Measures the functional engine on a tight loop with and without a POST_INST listener.  Without one, the ADD+BRp
+// and LDR+ADD pairs in the loop run as superinstructions; with one, every instruction boundary stays observable.
+// The JIT engine is measured on the same loop for comparison.
+
+static void benchmark(lc3::core::EngineType engine, bool observe, uint16_t iterations)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    lc3::core::Simulator simulator(printer, inputter, 0);
+
+    // Sums a word in a loop, then stops the machine by clearing the MCR.
+    uint16_t const program[] = {
+          0xE408    // x3000: LEA R2, x3009
+        , 0x2208    // x3001: LD R1, x300A
+        , 0x6680    // x3002: LDR R3, R2, #0
+        , 0x1903    // x3003: ADD R4, R4, R3
+        , 0x127F    // x3004: ADD R1, R1, #-1
+        , 0x03FC    // x3005: BRp x3002
+        , 0x5020    // x3006: AND R0, R0, #0
+        , 0xB003    // x3007: STI R0, x300B
+        , 0x0FFF    // x3008: BRnzp x3008
+        , 0x0003    // x3009: .FILL #3
+        , iterations// x300A: .FILL iterations
+        , 0xFFFE    // x300B: .FILL MCR
+    };
+    lc3::core::MachineState & state = simulator.getMachineState();
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); ++i) {
+        state.writeMem(0x3000 + i, program[i]);
+    }
+
+    uint64_t inst_count = 0;
+    if(observe) {
+        simulator.registerCallback(lc3::core::CallbackType::POST_INST,
+            [&inst_count](lc3::core::CallbackType type, lc3::core::MachineState & state) {
+                (void) type; (void) state;
+                inst_count += 1;
+            });
+    }
+    simulator.setIgnorePrivilege(true);
+    simulator.setEngine(engine);
+    state.writePC(0x3000);
+
+    std::chrono::nanoseconds elapsed = bench::measure([&simulator](void) { simulator.simulate(); });
+
+    if(! observe) {
+        inst_count = 4 + 4 * static_cast<uint64_t>(iterations);
+    }
+    lc3::core::sim::BlockCacheStats const & stats = simulator.getBlockCacheStats();
+    std::printf("%-12s %-12s %12.1f %10" PRIu64 " %10" PRIu64 " %14" PRIu64 "\n",
+        engine == lc3::core::EngineType::JIT ? "jit" : "functional", observe ? "POST_INST" : "none",
+        bench::nsPer(elapsed, inst_count), stats.hits, stats.misses, stats.invalidations);
+}
+
+int main(int argc, char * argv[])
+{
+    uint16_t iterations = 30000;
+    if(argc > 1) {
+        iterations = static_cast<uint16_t>(std::strtoul(argv[1], nullptr, 10) & 0x7FFF);
+    }
+
+    std::printf("%-12s %-12s %12s %10s %10s %14s\n", "engine", "listener", "ns/inst", "hits", "misses",
+        "invalidations");
+    benchmark(lc3::core::EngineType::FUNCTIONAL, false, iterations);
+    benchmark(lc3::core::EngineType::FUNCTIONAL, true, iterations);
+    benchmark(lc3::core::EngineType::JIT, false, iterations);
+
+    return 0;
+}
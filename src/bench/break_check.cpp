@@ -0,0 +1,79 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "bench.h"
+#include "inputter.h"
+#include "printer.h"
+#include "simulator.h"
+
+// Measures the per-instruction cost of the functional engine running a loop over an array while breakpoints and
+// watchpoints are set on code and data the loop never reaches, i.e. the cost of checking for them.
+
+static double benchmark(uint32_t breakpoint_count, uint32_t watchpoint_count, uint32_t runs)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    lc3::core::Simulator simulator(printer, inputter, 0);
+    lc3::core::MachineState & state = simulator.getMachineState();
+
+    uint16_t const program[] = {
+          0x2208    // x3000: LD R1, COUNT
+        , 0x2408    // x3001: LOOP LD R2, ARRAY
+        , 0x6680    // x3002: LDR R3, R2, #0
+        , 0x16E1    // x3003: ADD R3, R3, #1
+        , 0x7680    // x3004: STR R3, R2, #0
+        , 0x127F    // x3005: ADD R1, R1, #-1
+        , 0x03FA    // x3006: BRp LOOP
+        , 0x5FE0    // x3007: AND R7, R7, #0
+        , 0xBE03    // x3008: STI R7, MCR_ADDR
+        , 0x4E20    // x3009: COUNT .FILL #20000
+        , 0x4000    // x300A: ARRAY .FILL x4000
+        , 0x0000    // x300B:
+        , MCR       // x300C: MCR_ADDR .FILL MCR
+    };
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); ++i) {
+        state.writeMem(0x3000 + i, program[i]);
+    }
+    for(uint32_t i = 0; i < breakpoint_count; i += 1) {
+        simulator.addBreakpoint(static_cast<uint16_t>(0x5000 + i * 7));
+    }
+    for(uint32_t i = 0; i < watchpoint_count; i += 1) {
+        simulator.addWatchpoint(static_cast<uint16_t>(0x6000 + i * 16), static_cast<uint16_t>(0x6000 + i * 16 + 7),
+            lc3::core::WatchType::ACCESS, lc3::core::BreakCondition(), 0);
+    }
+    simulator.setIgnorePrivilege(true);
+
+    uint64_t inst_count = 0;
+    std::chrono::nanoseconds elapsed(0);
+    for(uint32_t run = 0; run < runs; run += 1) {
+        state.writePC(0x3000);
+
+        elapsed += bench::measure([&simulator](void) { simulator.simulate(); });
+        inst_count += simulator.getInstExecCount();
+    }
+
+    return bench::nsPer(elapsed, inst_count);
+}
+
+int main(int argc, char * argv[])
+{
+    uint32_t runs = 20;
+    if(argc > 1) {
+        runs = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+
+    std::printf("%-12s %-12s %14s\n", "breakpoints", "watchpoints", "ns/inst");
+    for(uint32_t breakpoint_count : { 0u, 1u, 64u, 1024u }) {
+        std::printf("%-12u %-12u %14.1f\n", breakpoint_count, 0u, benchmark(breakpoint_count, 0, runs));
+    }
+    for(uint32_t watchpoint_count : { 1u, 64u }) {
+        std::printf("%-12u %-12u %14.1f\n", 0u, watchpoint_count, benchmark(0, watchpoint_count, runs));
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "bench.h"
+#include "inputter.h"
+#include "interface.h"
+#include "printer.h"
+
+// Measures the cost of output-heavy programs: a loop that prints a line with PUTS, collected by a printer that
+// flushes every call to a file, as the console and file printers do, and by one that appends to a string.
+
+class FlushingPrinter : public lc3::utils::IPrinter
+{
+public:
+    FlushingPrinter(void) : calls(0), file(std::fopen("/dev/null", "w")) { }
+    ~FlushingPrinter(void) { if(file != nullptr) { std::fclose(file); } }
+
+    virtual void setColor(lc3::utils::PrintColor color) override { (void) color; }
+    virtual void print(std::string const & string) override { printChars(string.data(), string.size()); }
+    virtual void newline(void) override { printChars("\n", 1); }
+    virtual void printChars(char const * chars, size_t count) override
+    {
+        calls += 1;
+        if(file != nullptr) {
+            std::fwrite(chars, 1, count, file);
+            std::fflush(file);
+        }
+    }
+
+    uint64_t calls;
+
+private:
+    std::FILE * file;
+};
+
+class StringPrinter : public lc3::utils::IPrinter
+{
+public:
+    virtual void setColor(lc3::utils::PrintColor color) override { (void) color; }
+    virtual void print(std::string const & string) override { output.append(string); }
+    virtual void newline(void) override { output += '\n'; }
+    virtual void printChars(char const * chars, size_t count) override { output.append(chars, count); }
+
+    std::string output;
+};
+
+static char const message[] = "The quick brown fox jumps over the lazy dog, again and again.\n";
+
+static double benchmark(lc3::core::EngineType engine, lc3::utils::IPrinter & printer, uint16_t lines, uint32_t runs)
+{
+    lc3::utils::NullInputter inputter;
+    // Simulator output is only printed from print level 1.
+    lc3::sim simulator(printer, inputter, 1);
+
+    uint16_t const program[] = {
+          0x2205    // x3000: LD R1, COUNT
+        , 0xE005    // x3001: LOOP LEA R0, MSG
+        , 0xF022    // x3002: PUTS
+        , 0x127F    // x3003: ADD R1, R1, #-1
+        , 0x03FC    // x3004: BRp LOOP
+        , 0xF025    // x3005: HALT
+        , lines     // x3006: COUNT .FILL
+    };
+    uint16_t addr = 0x3000;
+    for(uint16_t value : program) {
+        simulator.writeMem(addr++, value);
+    }
+    for(char c : message) {
+        simulator.writeMem(addr++, static_cast<uint16_t>(c));
+    }
+
+    simulator.setEngine(engine);
+    simulator.setup();
+
+    std::chrono::nanoseconds elapsed(0);
+    for(uint32_t run = 0; run < runs; run += 1) {
+        simulator.writePC(0x3000);
+
+        elapsed += bench::measure([&simulator](void) { simulator.runUntilHalt(); });
+    }
+
+    return static_cast<double>(elapsed.count()) / runs / 1000;
+}
+
+int main(int argc, char * argv[])
+{
+    uint32_t runs = 20;
+    if(argc > 1) {
+        runs = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    uint16_t const lines = 1000;
+
+    std::printf("%u lines of %u characters per run\n", lines, static_cast<uint32_t>(sizeof(message) - 1));
+    std::printf("%-14s %-10s %14s\n", "engine", "printer", "us/run");
+    for(lc3::core::EngineType engine : { lc3::core::EngineType::FUNCTIONAL, lc3::core::EngineType::JIT }) {
+        char const * name = engine == lc3::core::EngineType::FUNCTIONAL ? "functional" : "jit";
+        FlushingPrinter file_printer;
+        StringPrinter string_printer;
+        std::printf("%-14s %-10s %14.1f\n", name, "file", benchmark(engine, file_printer, lines, runs));
+        std::printf("%-14s %-10s %14.1f\n", name, "file calls", static_cast<double>(file_printer.calls) / runs);
+        std::printf("%-14s %-10s %14.1f\n", name, "string", benchmark(engine, string_printer, lines, runs));
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "event_queue.h"
+#include "state.h"
+
+// Measures the cost of scheduling and dispatching events on the simulator's timing wheel against the priority queue
+// of shared_ptr events it replaced.  The first workload follows the cycle-timed engine, which schedules a handful of
+// events within one instruction step of the current time and then drains the queue; the second schedules events far
+// apart so that most of them go through the wheel's overflow list.
+
+class CountEvent : public lc3::core::IEvent
+{
+public:
+    CountEvent(uint64_t time, uint64_t & count) : IEvent(time), count(count) { }
+
+    virtual void handleEvent(lc3::core::MachineState & state) override { (void) state; count += 1; }
+    virtual std::string toString(lc3::core::MachineState const & state) const override
+    {
+        (void) state;
+        return "count";
+    }
+
+private:
+    uint64_t & count;
+};
+
+// The previous scheduler: shared_ptr events in a binary heap, compared through a functor that takes them by value.
+class HeapQueue
+{
+public:
+    template<typename T, typename ... Args>
+    void emplace(Args && ... args) { events.emplace(std::make_shared<T>(std::forward<Args>(args)...)); }
+    std::shared_ptr<lc3::core::IEvent> pop(void)
+    {
+        std::shared_ptr<lc3::core::IEvent> event = events.top();
+        events.pop();
+        return event;
+    }
+    bool empty(void) const { return events.empty(); }
+
+private:
+    struct Greater
+    {
+        bool operator()(std::shared_ptr<lc3::core::IEvent> lhs, std::shared_ptr<lc3::core::IEvent> rhs)
+        {
+            return lhs->time > rhs->time;
+        }
+    };
+
+    std::priority_queue<std::shared_ptr<lc3::core::IEvent>, std::vector<std::shared_ptr<lc3::core::IEvent>>,
+        Greater> events;
+};
+
+// Handed to the events, which ignore it.
+static lc3::core::MachineState state;
+
+template<typename Queue>
+static uint64_t drain(Queue & queue, uint64_t & time)
+{
+    uint64_t checksum = 0;
+    while(! queue.empty()) {
+        auto event = queue.pop();
+        time = event->time;
+        checksum += time;
+        event->handleEvent(state);
+    }
+    return checksum;
+}
+
+// Same schedule as Simulator::handleDevices and Simulator::handleInstruction, with two devices.
+template<typename Queue>
+static uint64_t instructions(uint64_t inst_count, uint64_t & count)
+{
+    Queue queue;
+    uint64_t time = 0, checksum = 0;
+    for(uint64_t i = 0; i < inst_count; i += 1) {
+        uint64_t offset = 20 - (time % 20);
+        queue.template emplace<CountEvent>(time + offset - 10, count);
+        queue.template emplace<CountEvent>(time + offset - 10, count);
+        queue.template emplace<CountEvent>(time + offset - 9, count);
+        checksum += drain(queue, time);
+
+        offset = 20 - (time % 20);
+        queue.template emplace<CountEvent>(time + offset - 2, count);
+        queue.template emplace<CountEvent>(time + offset, count);
+        checksum += drain(queue, time);
+
+        queue.template emplace<CountEvent>(time + offset + 8, count);
+        checksum += drain(queue, time);
+    }
+    return checksum;
+}
+
+template<typename Queue>
+static uint64_t scattered(uint64_t event_count, uint64_t & count)
+{
+    Queue queue;
+    std::mt19937_64 rng(0x4C43);
+    uint64_t time = 0, checksum = 0;
+    for(uint64_t i = 0; i < event_count; i += 64) {
+        for(uint64_t j = 0; j < 64; j += 1) {
+            queue.template emplace<CountEvent>(time + rng() % 10000, count);
+        }
+        checksum += drain(queue, time);
+    }
+    return checksum;
+}
+
+template<typename Queue>
+static void benchmark(char const * workload, char const * name, uint64_t (*run)(uint64_t, uint64_t &), uint64_t n)
+{
+    uint64_t count = 0, checksum = 0;
+    std::chrono::nanoseconds elapsed = bench::measure([&](void) { checksum = run(n, count); });
+    std::printf("%-14s %-16s %12.1f %20" PRIu64 "\n", workload, name, bench::nsPer(elapsed, count), checksum);
+}
+
+int main(int argc, char * argv[])
+{
+    uint64_t n = 1000000;
+    if(argc > 1) {
+        n = std::strtoull(argv[1], nullptr, 10);
+    }
+
+    std::printf("%-14s %-16s %12s %20s\n", "workload", "queue", "ns/event", "checksum");
+    benchmark<HeapQueue>("instructions", "priority_queue", instructions<HeapQueue>, n);
+    benchmark<lc3::core::sim::EventQueue>("instructions", "timing wheel", instructions<lc3::core::sim::EventQueue>, n);
+    benchmark<HeapQueue>("scattered", "priority_queue", scattered<HeapQueue>, n);
+    benchmark<lc3::core::sim::EventQueue>("scattered", "timing wheel", scattered<lc3::core::sim::EventQueue>, n);
+
+    return 0;
+}
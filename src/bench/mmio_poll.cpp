@@ -0,0 +1,98 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "bench.h"
+#include "device_regs.h"
+#include "inputter.h"
+#include "printer.h"
+#include "simulator.h"
+
+// Measures the per-instruction cost of a loop that keeps loading from a device register, as the OS's GETC and OUT
+// loops do, against the same loop loading from ordinary memory, as well as the cost of the accesses themselves.
+
+static double benchmark(lc3::core::EngineType engine, uint16_t addr, uint32_t runs)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    lc3::core::Simulator simulator(printer, inputter, 0);
+    lc3::core::MachineState & state = simulator.getMachineState();
+
+    uint16_t const program[] = {
+          0x2006    // x3000: LD R0, COUNT
+        , 0xA204    // x3001: LOOP LDI R1, ADDR
+        , 0x103F    // x3002: ADD R0, R0, #-1
+        , 0x03FD    // x3003: BRp LOOP
+        , 0x5FE0    // x3004: AND R7, R7, #0
+        , 0xBE02    // x3005: STI R7, x3008
+        , addr      // x3006: ADDR .FILL addr
+        , 0x7530    // x3007: COUNT .FILL #30000
+        , MCR       // x3008: .FILL MCR
+    };
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); ++i) {
+        state.writeMem(0x3000 + i, program[i]);
+    }
+    simulator.setIgnorePrivilege(true);
+    simulator.setEngine(engine);
+
+    uint64_t inst_count = 0;
+    std::chrono::nanoseconds elapsed(0);
+    for(uint32_t run = 0; run < runs; run += 1) {
+        state.writePC(0x3000);
+
+        elapsed += bench::measure([&simulator](void) { simulator.simulate(); });
+        inst_count += simulator.getInstExecCount();
+    }
+
+    return bench::nsPer(elapsed, inst_count);
+}
+
+// Keeps the loads in accessBenchmark from being optimized away.
+static volatile uint32_t access_sink;
+
+static double accessBenchmark(uint16_t addr, uint32_t count)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    lc3::core::Simulator simulator(printer, inputter, 0);
+    lc3::core::MachineState & state = simulator.getMachineState();
+
+    uint32_t sum = 0;
+    std::chrono::nanoseconds elapsed = bench::measure([&](void) {
+        for(uint32_t i = 0; i < count; i += 1) {
+            sum += std::get<0>(state.readMem(addr));
+            state.writeMem(addr, static_cast<uint16_t>(i));
+        }
+    });
+
+    access_sink = sum;
+    return bench::nsPer(elapsed, count);
+}
+
+int main(int argc, char * argv[])
+{
+    uint32_t runs = 50;
+    if(argc > 1) {
+        runs = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+
+    std::printf("%-12s %-10s %14s\n", "engine", "load from", "ns/inst");
+    for(lc3::core::EngineType engine : { lc3::core::EngineType::FUNCTIONAL, lc3::core::EngineType::JIT }) {
+        char const * name = engine == lc3::core::EngineType::JIT ? "jit" : "functional";
+        std::printf("%-12s %-10s %14.1f\n", name, "memory", benchmark(engine, 0x4000, runs));
+        std::printf("%-12s %-10s %14.1f\n", name, "DSR", benchmark(engine, DSR, runs));
+        std::printf("%-12s %-10s %14.1f\n", name, "KBSR", benchmark(engine, KBSR, runs));
+    }
+
+
+    std::printf("\n%-12s %14s\n", "read/write", "ns/access");
+    std::printf("%-12s %14.1f\n", "memory", accessBenchmark(0x4000, 10000000));
+    std::printf("%-12s %14.1f\n", "DSR", accessBenchmark(DSR, 10000000));
+    std::printf("%-12s %14.1f\n", "PSR", accessBenchmark(PSR, 10000000));
+
+    return 0;
+}
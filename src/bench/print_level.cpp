@@ -0,0 +1,61 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "bench.h"
+#include "inputter.h"
+#include "interface.h"
+#include "printer.h"
+
+// Measures the per-instruction cost of the simulator at print level 0 versus print level 9.  Output is formatted
+// but discarded, so the difference is the cost of building trace messages rather than of writing them out.
+
+static double benchmark(lc3::core::EngineType engine, uint32_t print_level, uint64_t inst_count)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    lc3::sim simulator(printer, inputter, print_level);
+
+    // Counting loop that calls a subroutine on every iteration, so stack trace messages are generated as well.
+    uint16_t const program[] = {
+          0x5020    // x3000: AND R0, R0, #0
+        , 0x1021    // x3001: ADD R0, R0, #1
+        , 0x4801    // x3002: JSR x3004
+        , 0x0FFD    // x3003: BRnzp x3001
+        , 0x1262    // x3004: ADD R1, R1, #2
+        , 0xC1C0    // x3005: RET
+    };
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); ++i) {
+        simulator.writeMem(0x3000 + i, program[i]);
+    }
+
+    simulator.setEngine(engine);
+    simulator.setup();
+    simulator.writePC(0x3000);
+    simulator.setRunInstLimit(inst_count);
+
+    std::chrono::nanoseconds elapsed = bench::measure([&simulator](void) { simulator.run(); });
+    return bench::nsPer(elapsed, simulator.getInstExecCount());
+}
+
+int main(int argc, char * argv[])
+{
+    uint64_t inst_count = 200000;
+    if(argc > 1) {
+        inst_count = std::strtoull(argv[1], nullptr, 10);
+    }
+
+    std::printf("%-14s %-12s %14s\n", "engine", "print level", "ns/inst");
+    std::printf("%-14s %-12d %14.1f\n", "functional", 0,
+        benchmark(lc3::core::EngineType::FUNCTIONAL, 0, inst_count));
+    std::printf("%-14s %-12d %14.1f\n", "cycle-timed", 0,
+        benchmark(lc3::core::EngineType::CYCLE_TIMED, 0, inst_count));
+    std::printf("%-14s %-12d %14.1f\n", "cycle-timed", 9,
+        benchmark(lc3::core::EngineType::CYCLE_TIMED, 9, inst_count));
+
+    return 0;
+}
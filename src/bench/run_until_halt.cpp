@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "bench.h"
+#include "inputter.h"
+#include "interface.h"
+#include "printer.h"
+
+// Measures the per-instruction cost of lc3::sim::runUntilHalt on a counting loop, with nothing listening to the run
+// and with a post-instruction callback registered.
+
+static double benchmark(lc3::core::EngineType engine, bool observed, uint32_t runs)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    lc3::sim simulator(printer, inputter, 0);
+
+    uint16_t const program[] = {
+          0x2204    // x3000: LD R1, x3005
+        , 0x1021    // x3001: ADD R0, R0, #1
+        , 0x127F    // x3002: ADD R1, R1, #-1
+        , 0x03FD    // x3003: BRp x3001
+        , 0xF025    // x3004: HALT
+        , 0x7FFF    // x3005: .FILL x7FFF
+    };
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); ++i) {
+        simulator.writeMem(0x3000 + i, program[i]);
+    }
+
+    uint64_t callback_count = 0;
+    if(observed) {
+        simulator.registerCallback(lc3::core::CallbackType::POST_INST,
+            [&callback_count](lc3::core::CallbackType, lc3::sim &) { callback_count += 1; });
+    }
+
+    simulator.setEngine(engine);
+    simulator.setup();
+
+    uint64_t start_count = simulator.getInstExecCount();
+    std::chrono::nanoseconds elapsed(0);
+    for(uint32_t run = 0; run < runs; run += 1) {
+        simulator.writePC(0x3000);
+
+        elapsed += bench::measure([&simulator](void) { simulator.runUntilHalt(); });
+    }
+
+    return bench::nsPer(elapsed, simulator.getInstExecCount() - start_count);
+}
+
+int main(int argc, char * argv[])
+{
+    uint32_t runs = 20;
+    if(argc > 1) {
+        runs = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+
+    std::printf("%-14s %-10s %14s\n", "engine", "callback", "ns/inst");
+    for(lc3::core::EngineType engine : { lc3::core::EngineType::FUNCTIONAL, lc3::core::EngineType::CYCLE_TIMED,
+        lc3::core::EngineType::JIT })
+    {
+        char const * name = engine == lc3::core::EngineType::FUNCTIONAL ? "functional" :
+            (engine == lc3::core::EngineType::CYCLE_TIMED ? "cycle-timed" : "jit");
+        std::printf("%-14s %-10s %14.1f\n", name, "none", benchmark(engine, false, runs));
+        std::printf("%-14s %-10s %14.1f\n", name, "post-inst", benchmark(engine, true, runs));
+    }
+
+    return 0;
+}
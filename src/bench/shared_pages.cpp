@@ -0,0 +1,77 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "inputter.h"
+#include "interface.h"
+#include "printer.h"
+
+// Measures how much memory each of many simulators in one process costs once the OS is loaded, and how much more a
+// short program that stores to a single page adds.  The OS pages are shared by every simulator, so only the pages a
+// program writes to should show up.  Resident memory is read from /proc, so it is only reported on Linux.
+
+static uint16_t const program[] = {
+      0x2206    // x3000: LD R1, COUNT
+    , 0x2406    // x3001: LD R2, ARRAY
+    , 0x7280    // x3002: LOOP STR R1, R2, #0
+    , 0x14A1    // x3003: ADD R2, R2, #1
+    , 0x127F    // x3004: ADD R1, R1, #-1
+    , 0x03FC    // x3005: BRp LOOP
+    , 0xF025    // x3006: HALT
+    , 0x0040    // x3007: COUNT .FILL #64
+    , 0x4000    // x3008: ARRAY .FILL x4000
+};
+
+static double residentKB(void)
+{
+    std::ifstream statm("/proc/self/statm");
+    unsigned long size = 0, resident = 0;
+    if(! (statm >> size >> resident)) {
+        return 0;
+    }
+    return static_cast<double>(resident) * 4;
+}
+
+int main(int argc, char * argv[])
+{
+    uint32_t count = 1000;
+    if(argc > 1) {
+        count = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    std::vector<std::unique_ptr<lc3::sim>> simulators;
+
+    double const base_kb = residentKB();
+    std::chrono::nanoseconds elapsed = bench::measure([&](void) {
+        for(uint32_t i = 0; i < count; i += 1) {
+            simulators.emplace_back(new lc3::sim(printer, inputter, 0));
+        }
+    });
+    double const loaded_kb = residentKB();
+
+    for(std::unique_ptr<lc3::sim> & simulator : simulators) {
+        for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); ++i) {
+            simulator->writeMem(0x3000 + i, program[i]);
+        }
+        simulator->writePC(0x3000);
+        simulator->runUntilHalt();
+    }
+    double const run_kb = residentKB();
+
+    std::printf("%u simulators, %.1f us to create each\n", count, bench::nsPer(elapsed, count) / 1000);
+    std::printf("%-10s %14s\n", "stage", "KB each");
+    std::printf("%-10s %14.1f\n", "loaded", (loaded_kb - base_kb) / count);
+    std::printf("%-10s %14.1f\n", "run", (run_kb - loaded_kb) / count);
+
+    return 0;
+}
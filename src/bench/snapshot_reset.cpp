@@ -0,0 +1,84 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "bench.h"
+#include "inputter.h"
+#include "interface.h"
+#include "printer.h"
+
+// Measures the cost of getting a randomized machine with a program loaded ready for a test case, either by building
+// a new simulator as the test frameworks used to or by restoring a snapshot of one, along with the cost of a short
+// run that stores to memory afterwards, which is where pages shared with the snapshot are copied.
+
+static uint16_t const program[] = {
+      0x2206    // x3000: LD R1, COUNT
+    , 0x2406    // x3001: LD R2, ARRAY
+    , 0x7280    // x3002: LOOP STR R1, R2, #0
+    , 0x14A1    // x3003: ADD R2, R2, #1
+    , 0x127F    // x3004: ADD R1, R1, #-1
+    , 0x03FC    // x3005: BRp LOOP
+    , 0xF025    // x3006: HALT
+    , 0x0040    // x3007: COUNT .FILL #64
+    , 0x4000    // x3008: ARRAY .FILL x4000
+};
+
+static void load(lc3::sim & simulator)
+{
+    simulator.randomizeState(1234);
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); ++i) {
+        simulator.writeMem(0x3000 + i, program[i]);
+    }
+    simulator.writePC(0x3000);
+}
+
+static void benchmark(bool restore, uint32_t runs)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    lc3::core::PMachineSnapshot image;
+    if(restore) {
+        lc3::sim simulator(printer, inputter, 0);
+        load(simulator);
+        image = simulator.snapshot();
+    }
+
+    std::unique_ptr<lc3::sim> simulator;
+    std::chrono::nanoseconds reset_elapsed(0), run_elapsed(0);
+    for(uint32_t run = 0; run < runs; run += 1) {
+        reset_elapsed += bench::measure([&](void) {
+            if(restore) {
+                if(simulator == nullptr) {
+                    simulator.reset(new lc3::sim(printer, inputter, 0));
+                }
+                simulator->restore(image);
+            } else {
+                simulator.reset(new lc3::sim(printer, inputter, 0));
+                load(*simulator);
+            }
+        });
+        run_elapsed += bench::measure([&simulator](void) { simulator->runUntilHalt(); });
+    }
+
+    std::printf("%-10s %14.1f %14.1f\n", restore ? "restore" : "rebuild",
+        bench::nsPer(reset_elapsed, runs) / 1000, bench::nsPer(run_elapsed, runs) / 1000);
+}
+
+int main(int argc, char * argv[])
+{
+    uint32_t runs = 200;
+    if(argc > 1) {
+        runs = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+
+    std::printf("%-10s %14s %14s\n", "reset", "reset us", "run us");
+    benchmark(false, runs);
+    benchmark(true, runs);
+
+    return 0;
+}
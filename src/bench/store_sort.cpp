@@ -0,0 +1,108 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "inputter.h"
+#include "printer.h"
+#include "simulator.h"
+
+// Measures a store-heavy workload: a bubble sort over data placed where the sort sample places it.  The data is
+// sorted either as plain words or as the characters of a .STRINGZ, whose display lines follow the values stored into
+// them.
+
+static constexpr uint16_t DATA_ADDR = 0x32F0;
+
+static double benchmark(lc3::core::EngineType engine, bool stringz, uint32_t runs)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    lc3::core::Simulator simulator(printer, inputter, 0);
+    lc3::core::MachineState & state = simulator.getMachineState();
+
+    // The sample's example data, and a string, each repeated so that there is enough to sort.
+    std::vector<uint16_t> const example = {
+        0xFFFF, 0x0062, 0x0A73, 0x006C, 0x0070, 0x0001, 0x0063, 0x0065,
+        0x0062, 0x0073, 0x006E, 0x006B, 0xFF76, 0x0F7A, 0x0068, 0x006D
+    };
+    std::vector<uint16_t> data;
+    for(uint32_t i = 0; i < 4; i += 1) {
+        if(stringz) {
+            std::string const characters = "the quick brown fox jumps over the lazy dog ";
+            data.insert(data.end(), characters.begin(), characters.end());
+        } else {
+            data.insert(data.end(), example.begin(), example.end());
+        }
+    }
+    uint16_t const count = static_cast<uint16_t>(data.size());
+
+    uint16_t const program[] = {
+          0x2013    // x3000: LD R0, DATA
+        , 0x2213    // x3001: LD R1, COUNT
+        , 0x127F    // x3002: OUTER ADD R1, R1, #-1
+        , 0x0C0E    // x3003: BRnz DONE
+        , 0x1420    // x3004: ADD R2, R0, #0
+        , 0x1660    // x3005: ADD R3, R1, #0
+        , 0x6880    // x3006: INNER LDR R4, R2, #0
+        , 0x6A81    // x3007: LDR R5, R2, #1
+        , 0x9D3F    // x3008: NOT R6, R4
+        , 0x1DA1    // x3009: ADD R6, R6, #1
+        , 0x1D85    // x300A: ADD R6, R6, R5
+        , 0x0602    // x300B: BRzp NOSWAP
+        , 0x7A80    // x300C: STR R5, R2, #0
+        , 0x7881    // x300D: STR R4, R2, #1
+        , 0x14A1    // x300E: NOSWAP ADD R2, R2, #1
+        , 0x16FF    // x300F: ADD R3, R3, #-1
+        , 0x03F5    // x3010: BRp INNER
+        , 0x0FF0    // x3011: BRnzp OUTER
+        , 0x5FE0    // x3012: DONE AND R7, R7, #0
+        , 0xBE02    // x3013: STI R7, x3016
+        , DATA_ADDR // x3014: DATA .FILL x32F0
+        , count     // x3015: COUNT .FILL
+        , 0xFFFE    // x3016: .FILL MCR
+    };
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); ++i) {
+        state.writeMem(0x3000 + i, program[i]);
+    }
+    simulator.setIgnorePrivilege(true);
+    simulator.setEngine(engine);
+
+    uint64_t inst_count = 0;
+    std::chrono::nanoseconds elapsed(0);
+    for(uint32_t run = 0; run < runs; run += 1) {
+        for(uint16_t i = 0; i < count; ++i) {
+            state.writeMem(DATA_ADDR + i, data[i]);
+            if(stringz) {
+                state.setMemLine(DATA_ADDR + i, std::string(1, static_cast<char>(data[i])));
+            }
+        }
+        state.writePC(0x3000);
+
+        elapsed += bench::measure([&simulator](void) { simulator.simulate(); });
+        inst_count += simulator.getInstExecCount();
+    }
+
+    return bench::nsPer(elapsed, inst_count);
+}
+
+int main(int argc, char * argv[])
+{
+    uint32_t runs = 200;
+    if(argc > 1) {
+        runs = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+
+    std::printf("%-12s %-12s %14s\n", "engine", "data", "ns/inst");
+    for(lc3::core::EngineType engine : { lc3::core::EngineType::FUNCTIONAL, lc3::core::EngineType::JIT }) {
+        char const * name = engine == lc3::core::EngineType::JIT ? "jit" : "functional";
+        std::printf("%-12s %-12s %14.1f\n", name, "words", benchmark(engine, false, runs));
+        std::printf("%-12s %-12s %14.1f\n", name, "stringz", benchmark(engine, true, runs));
+    }
+
+    return 0;
+}
@@ -19,6 +19,10 @@ namespace lc3
         virtual void setColor(utils::PrintColor color) override { (void) color; return; }
         virtual void print(std::string const & string) override { output << string << std::flush; }
         virtual void newline(void) override { output << "\n"; }
+        virtual void printChars(char const * chars, size_t count) override
+        {
+            output.write(chars, count) << std::flush;
+        }
 
     private:
         std::ofstream output;
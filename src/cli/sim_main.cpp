@@ -2,6 +2,7 @@
  * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
  */
 #include <algorithm>
+#include <cctype>
 #ifdef _ENABLE_DEBUG
     #include <chrono>
 #endif
@@ -24,8 +25,16 @@ struct Breakpoint
     uint16_t loc;
     uint64_t id;
     lc3::sim * sim_inst;
-
-    Breakpoint(uint16_t loc, uint64_t id, lc3::sim * sim_inst) : loc(loc), id(id), sim_inst(sim_inst) { }
+    lc3::core::BreakCondition condition;
+    uint64_t ignore_count;
+    // Watchpoints cover loc to end, and are known to the simulator by watch_id.
+    bool watch;
+    uint16_t end;
+    lc3::core::WatchType type;
+    uint32_t watch_id;
+
+    Breakpoint(uint16_t loc, uint64_t id, lc3::sim * sim_inst) : loc(loc), id(id), sim_inst(sim_inst),
+        ignore_count(0), watch(false), end(loc), type(lc3::core::WatchType::ACCESS), watch_id(0) { }
 };
 
 std::vector<Breakpoint> breakpoints;
@@ -38,6 +47,7 @@ void promptBreak(lc3::sim & simulator, std::stringstream & command_tokens);
 void list(lc3::sim const & simulator, int32_t context);
 std::string formatMem(lc3::sim const & simulator, uint32_t addr);
 std::ostream & operator<<(std::ostream & out, Breakpoint const & x);
+bool parseBreakOptions(std::stringstream & command_tokens, std::string token, Breakpoint & bp);
 void breakpointCallback(lc3::core::CallbackType type, lc3::sim & sim);
 
 struct CLIArgs
@@ -122,10 +132,19 @@ void help(void)
 
 void breakHelp(void)
 {
-    std::cout << "break clear <id>  - clears the given breakpoint\n"
-              << "break help        - display this message\n"
-              << "break list        - display the active breakpoints\n"
-              << "break set <loc>   - sets a breakpoint at the given location\n"
+    std::cout << "break clear <id>                     - clears the given breakpoint or watchpoint\n"
+              << "break help                           - display this message\n"
+              << "break list                           - display the active breakpoints and watchpoints\n"
+              << "break set <loc> [<options>]          - sets a breakpoint at the given location\n"
+              << "break watch <start> [<end>] [<type>] [<options>]\n"
+              << "                                     - stops after an instruction that accesses memory addresses\n"
+              << "                                       start to end, where type is read, write, or access\n"
+              << "                                       (default)\n"
+              << "\n"
+              << "options:\n"
+              << "  skip <N>                           - ignores the first N hits\n"
+              << "  if <condition>                     - only stops when the condition holds, e.g. R0 == x10,\n"
+              << "                                       MEM[x4000] < #0, or PC != x3000; must come last\n"
               ;
 }
 
@@ -331,7 +350,11 @@ void promptBreak(lc3::sim & simulator, std::stringstream & command_tokens)
             return x.id == id;
         });
         if(bp_search != breakpoints.end()) {
-            simulator.removeBreakpoint(bp_search->loc);
+            if(bp_search->watch) {
+                simulator.removeWatchpoint(bp_search->watch_id);
+            } else {
+                simulator.removeBreakpoint(bp_search->loc);
+            }
             breakpoints.erase(bp_search);
         } else {
             std::cout << "invalid id\n";
@@ -341,7 +364,9 @@ void promptBreak(lc3::sim & simulator, std::stringstream & command_tokens)
         breakHelp();
     } else if(command == "list") {
         for(auto x : breakpoints) {
-            std::cout << x << "\n";
+            uint64_t hits = x.watch ? simulator.getWatchpointHitCount(x.watch_id) :
+                simulator.getBreakpointHitCount(x.loc);
+            std::cout << x << " (hits: " << hits << ")\n";
         }
     } else if(command == "set") {
         std::string loc_s;
@@ -360,12 +385,80 @@ void promptBreak(lc3::sim & simulator, std::stringstream & command_tokens)
             return;
         }
 
-        simulator.setBreakpoint(loc);
         Breakpoint bp{static_cast<uint16_t>(loc), cur_breakpoint_id, &simulator};
+        std::string token;
+        command_tokens >> token;
+        if(! parseBreakOptions(command_tokens, command_tokens.fail() ? "" : token, bp)) {
+            return;
+        }
+
+        // The simulator keeps a single breakpoint per location, so a new one replaces the old.
+        breakpoints.erase(std::remove_if(breakpoints.begin(), breakpoints.end(), [&bp](Breakpoint const & x) {
+            return ! x.watch && x.loc == bp.loc;
+        }), breakpoints.end());
+        simulator.setBreakpoint(bp.loc, bp.condition, bp.ignore_count);
         breakpoints.push_back(bp);
         ++cur_breakpoint_id;
         std::cout << bp << "\n";
+    } else if(command == "watch") {
+        std::string start_s;
+        command_tokens >> start_s;
+        if(command_tokens.fail()) {
+            std::cout << "must supply start address\n";
+            return;
+        }
+
+        uint32_t start;
+        try {
+            start = std::stoi(start_s, 0, 0);
+        } catch(std::exception const & e) {
+            (void) e;
+            std::cout << "invalid address\n";
+            return;
+        }
+
+        Breakpoint bp{static_cast<uint16_t>(start), cur_breakpoint_id, &simulator};
+        bp.watch = true;
+
+        // The end address and the type are both optional, so each token is tried as the next thing that may come.
+        std::string token;
+        command_tokens >> token;
+        if(command_tokens.fail()) {
+            token = "";
+        } else if(std::isdigit(static_cast<unsigned char>(token[0]))) {
+            try {
+                bp.end = std::stoi(token, 0, 0);
+            } catch(std::exception const & e) {
+                (void) e;
+                std::cout << "invalid address\n";
+                return;
+            }
+            command_tokens >> token;
+            if(command_tokens.fail()) { token = ""; }
+        }
+        if(bp.end < bp.loc) {
+            std::swap(bp.loc, bp.end);
+        }
+        if(bp.end >= 0xFE00) {
+            std::cout << "cannot watch device registers\n";
+            return;
+        }
+
+        if(token == "read" || token == "write" || token == "access") {
+            bp.type = token == "read" ? lc3::core::WatchType::READ :
+                (token == "write" ? lc3::core::WatchType::WRITE : lc3::core::WatchType::ACCESS);
+            command_tokens >> token;
+            if(command_tokens.fail()) { token = ""; }
+        }
 
+        if(! parseBreakOptions(command_tokens, token, bp)) {
+            return;
+        }
+
+        bp.watch_id = simulator.setWatchpoint(bp.loc, bp.end, bp.type, bp.condition, bp.ignore_count);
+        breakpoints.push_back(bp);
+        ++cur_breakpoint_id;
+        std::cout << bp << "\n";
     } else  {
         std::cout << "unknown command\n";
     }
@@ -397,17 +490,81 @@ std::string formatMem(lc3::sim const & simulator, uint32_t addr)
 
 std::ostream & operator<<(std::ostream & out, Breakpoint const & x)
 {
-    out << "#" << x.id << ": " << formatMem(*(x.sim_inst), x.loc);
+    out << "#" << x.id << ": ";
+    if(x.watch) {
+        out << lc3::utils::ssprintf("watch %s 0x%0.4X", lc3::core::watchTypeToString(x.type).c_str(), x.loc);
+        if(x.end != x.loc) {
+            out << lc3::utils::ssprintf("-0x%0.4X", x.end);
+        }
+    } else {
+        out << formatMem(*(x.sim_inst), x.loc);
+    }
+
+    std::string condition = x.condition.toString();
+    if(condition != "") {
+        out << " if " << condition;
+    }
+    if(x.ignore_count != 0) {
+        out << " skip " << x.ignore_count;
+    }
     return out;
 }
 
+// Reads the skip and if options, the first token of which has already been taken out.
+bool parseBreakOptions(std::stringstream & command_tokens, std::string token, Breakpoint & bp)
+{
+    while(token != "") {
+        if(token == "skip") {
+            command_tokens >> bp.ignore_count;
+            if(command_tokens.fail()) {
+                std::cout << "must supply number of hits to skip\n";
+                return false;
+            }
+        } else if(token == "if") {
+            std::string condition_s;
+            std::getline(command_tokens, condition_s);
+            lc3::optional<lc3::core::BreakCondition> condition = lc3::core::BreakCondition::parse(condition_s);
+            if(! condition || condition->operand == lc3::core::BreakCondition::Operand::NONE) {
+                std::cout << "invalid condition\n";
+                return false;
+            }
+            bp.condition = *condition;
+            return true;
+        } else {
+            std::cout << "unknown option\n";
+            return false;
+        }
+
+        command_tokens >> token;
+        if(command_tokens.fail()) {
+            token = "";
+        }
+    }
+
+    return true;
+}
+
 void breakpointCallback(lc3::core::CallbackType type, lc3::sim & sim)
 {
     (void) type;
 
+    lc3::core::BreakHit const & hit = sim.getLastBreak();
+    if(hit.kind == lc3::core::BreakHit::Kind::WATCHPOINT) {
+        uint32_t watch_id = hit.watch_id;
+        auto bp_search = std::find_if(breakpoints.begin(), breakpoints.end(), [watch_id](Breakpoint const & x) {
+            return x.watch && x.watch_id == watch_id;
+        });
+        if(bp_search != breakpoints.end()) {
+            std::cout << "hit a watchpoint\n" << *bp_search << "\n";
+            std::cout << lc3::utils::ssprintf("%s 0x%0.4X by ", hit.write ? "write to" : "read from", hit.addr)
+                      << formatMem(sim, hit.pc) << "\n";
+        }
+        return;
+    }
+
     uint16_t pc = sim.readPC();
     auto bp_search = std::find_if(breakpoints.begin(), breakpoints.end(), [pc](Breakpoint const & x) {
-        return x.loc == pc;
+        return ! x.watch && x.loc == pc;
     });
     if(bp_search != breakpoints.end()) {
         // Should always be the case.
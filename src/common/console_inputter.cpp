@@ -4,14 +4,46 @@
 #include <iostream>
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32)
+    #include <chrono>
     #include <conio.h>
 #else
+    #include <cerrno>
+    #include <poll.h>
+    #include <sys/select.h>
     #include <termios.h>
     #include <unistd.h>
 #endif
 
 #include "console_inputter.h"
 
+lc3::ConsoleInputter::ConsoleInputter(void) : threaded(true)
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32)
+    stop_requested = false;
+#else
+    if(pipe(stop_pipe) != 0) {
+        // Without the pipe, the reader thread could never be stopped, so the console is polled instead.
+        stop_pipe[0] = -1;
+        stop_pipe[1] = -1;
+        threaded = false;
+    }
+#endif
+}
+
+lc3::ConsoleInputter::~ConsoleInputter(void)
+{
+    if(reader.joinable()) {
+        endInput();
+    }
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32))
+    if(stop_pipe[0] != -1) {
+        close(stop_pipe[0]);
+        close(stop_pipe[1]);
+    }
+#endif
+}
+
 void lc3::ConsoleInputter::beginInput(void)
 {
 #if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32))
@@ -23,18 +55,23 @@ void lc3::ConsoleInputter::beginInput(void)
     ttystate.c_cc[VMIN] = 1;
 
     tcsetattr(STDIN_FILENO, TCSANOW, &ttystate);
+
+    if(! threaded) { return; }
+#else
+    stop_requested = false;
 #endif
+
+    if(! reader.joinable()) {
+        reader = std::thread(&ConsoleInputter::readInput, this);
+    }
 }
 
 bool lc3::ConsoleInputter::getChar(char & c)
 {
-#if defined(WIN32) || defined(_WIN32) || defined(__WIN32)
-    if(_kbhit() != 0) {
-        c = _getch();
-        return true;
-    }
-#else
-    if(kbhit() != 0) {
+    if(buffer.pop(c)) { return true; }
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32))
+    if(! threaded && kbhit() != 0) {
         c = fgetc(stdin);
         return true;
     }
@@ -45,6 +82,19 @@ bool lc3::ConsoleInputter::getChar(char & c)
 
 void lc3::ConsoleInputter::endInput(void)
 {
+    // Anything already read stays in the buffer for the next run; anything else stays with the console.
+    if(reader.joinable()) {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32)
+        stop_requested = true;
+        reader.join();
+#else
+        char stop = 0;
+        while(write(stop_pipe[1], &stop, 1) < 0 && errno == EINTR) {}
+        reader.join();
+        while(read(stop_pipe[0], &stop, 1) < 0 && errno == EINTR) {}
+#endif
+    }
+
 #if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32))
     struct termios ttystate;
     tcgetattr(STDIN_FILENO, &ttystate);
@@ -54,6 +104,64 @@ void lc3::ConsoleInputter::endInput(void)
 #endif
 }
 
+void lc3::ConsoleInputter::setInputListener(std::function<void(void)> listener)
+{
+    std::lock_guard<std::mutex> const lock(listener_mutex);
+    this->listener = listener;
+}
+
+void lc3::ConsoleInputter::notifyListener(void)
+{
+    std::lock_guard<std::mutex> const lock(listener_mutex);
+    if(listener) { listener(); }
+}
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32)
+void lc3::ConsoleInputter::readInput(void)
+{
+    while(! stop_requested) {
+        if(! buffer.full() && _kbhit() != 0) {
+            buffer.push(static_cast<char>(_getch()));
+            notifyListener();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+#else
+void lc3::ConsoleInputter::readInput(void)
+{
+    struct pollfd fds[2];
+    fds[0].fd = stop_pipe[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = STDIN_FILENO;
+    fds[1].events = POLLIN;
+
+    while(true) {
+        // While the buffer is full, leave the input with the console and check back periodically.
+        bool full = buffer.full();
+        if(poll(fds, full ? 1 : 2, full ? 1 : -1) < 0) {
+            if(errno == EINTR) { continue; }
+            return;
+        }
+        if(fds[0].revents != 0) { return; }
+        if(full || fds[1].revents == 0) { continue; }
+
+        // Only this thread adds to the buffer, so there is still room for the character.
+        char c;
+        ssize_t count = read(STDIN_FILENO, &c, 1);
+        if(count < 0 && errno == EINTR) { continue; }
+        if(count <= 0) {
+            // The console has closed.
+            return;
+        }
+
+        buffer.push(c);
+        notifyListener();
+    }
+}
+#endif
+
 #if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32))
 int lc3::ConsoleInputter::kbhit(void)
 {
@@ -4,21 +4,45 @@
 #ifndef CONSOLE_INPUTTER_H
 #define CONSOLE_INPUTTER_H
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
 #include "inputter.h"
+#include "ring_buffer.h"
 
 namespace lc3 {
+    // Between beginInput and endInput, a reader thread moves keystrokes from the console into a buffer, so getChar
+    // never has to make a system call.  If the thread can't be set up, getChar polls the console instead.
     class ConsoleInputter : public utils::IInputter
     {
     public:
-        ConsoleInputter(void) = default;
-        ~ConsoleInputter(void) = default;
+        ConsoleInputter(void);
+        ~ConsoleInputter(void);
 
         virtual void beginInput(void) override;
         virtual bool getChar(char & c) override;
         virtual void endInput(void) override;
-        virtual bool hasRemaining(void) const override { return false; }
+        virtual bool hasRemaining(void) const override { return ! buffer.empty(); }
+        virtual bool isPolled(void) const override { return ! threaded; }
+        virtual void setInputListener(std::function<void(void)> listener) override;
 
     private:
+        utils::SPSCRing<char, 4096> buffer;
+        std::thread reader;
+        std::mutex listener_mutex;
+        std::function<void(void)> listener;
+        bool threaded;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32)
+        std::atomic<bool> stop_requested;
+#else
+        // Written to by endInput to wake the reader thread up from waiting on the console.
+        int stop_pipe[2];
+#endif
+
+        void readInput(void);
+        void notifyListener(void);
 #if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32))
         int kbhit(void);
 #endif
@@ -27,6 +27,11 @@ void lc3::ConsolePrinter::print(std::string const & string)
     std::cout << string << std::flush;
 }
 
+void lc3::ConsolePrinter::printChars(char const * chars, size_t count)
+{
+    std::cout.write(chars, count) << std::flush;
+}
+
 void lc3::ConsolePrinter::newline(void)
 {
     std::cout << "\n";
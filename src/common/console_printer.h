@@ -14,6 +14,7 @@ namespace lc3
         virtual void setColor(utils::PrintColor color) override;
         virtual void print(std::string const & string) override;
         virtual void newline(void) override;
+        virtual void printChars(char const * chars, size_t count) override;
     };
 };
 
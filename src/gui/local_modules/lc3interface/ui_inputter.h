@@ -4,23 +4,35 @@
 #ifndef UI_INPUTTER
 #define UI_INPUTTER
 
-#include <vector>
+#include <atomic>
+
+#include "ring_buffer.h"
 
 namespace utils
 {
+    // Keystrokes are added by the JS thread and taken by the simulator's worker thread through a ring that neither
+    // has to lock to use.  The only lock is the one around the listener.
     class UIInputter : public lc3::utils::IInputter
     {
     private:
-        std::mutex buffer_mutex;
-        std::vector<char> buffer;
+        lc3::utils::SPSCRing<char, 4096> buffer;
+        // Clearing is done by the JS thread, which may not take characters out of the ring, so it records how many
+        // characters had been added by then and the worker thread drops them.
+        uint64_t added;
+        uint64_t taken;
+        std::atomic<uint64_t> cleared;
+        std::mutex listener_mutex;
+        std::function<void(void)> listener;
 
     public:
-        UIInputter(void) = default;
+        UIInputter(void) : added(0), taken(0), cleared(0) {}
 
         virtual void beginInput(void) override {}
         virtual bool getChar(char & c) override;
         virtual void endInput(void) override {}
         virtual bool hasRemaining(void) const override { return false; }
+        virtual bool isPolled(void) const override { return false; }
+        virtual void setInputListener(std::function<void(void)> listener) override;
 
         void clearInput(void);
         void addInput(char c);
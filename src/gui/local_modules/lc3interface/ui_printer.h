@@ -4,24 +4,54 @@
 #ifndef UI_PRINTER
 #define UI_PRINTER
 
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace utils
 {
     class UIPrinter : public lc3::utils::IPrinter
     {
-    private:
-        std::mutex output_buffer_mutex;
-        std::vector<std::string> output_buffer;
-        uint32_t pending_colors;
-
     public:
-        UIPrinter(void) : pending_colors(0) {}
+        // Output since it was last taken: the text in one piece, and the color tags that go into it as the offsets
+        // they go before, so that printing only appends.  Once the text reaches the limit, further text is only
+        // counted.
+        struct Output
+        {
+            std::string text;
+            std::vector<std::pair<size_t, char const *>> tags;
+            uint64_t dropped;
+
+            Output(void) : dropped(0) {}
+            void clear(void) { text.clear(); tags.clear(); dropped = 0; }
+            // The text with its tags, as the console shows it, followed by a note about any text that was dropped.
+            std::string toHTML(void) const;
+        };
+
+        static constexpr size_t DEFAULT_OUTPUT_LIMIT = 1 << 18;
+
+        UIPrinter(void) : pending_colors(0), output_limit(DEFAULT_OUTPUT_LIMIT) {}
 
         virtual void setColor(lc3::utils::PrintColor color) override;
         virtual void print(std::string const & string) override;
         virtual void newline(void) override;
+        virtual void printChars(char const * chars, size_t count) override;
 
-        std::vector<std::string> getAndClearOutputBuffer(void);
+        // Swaps the output so far with taken, which is cleared first, so that the output is handed over without
+        // being copied and the buffers are reused.
+        void takeOutput(Output & taken);
         void clearOutputBuffer(void);
+        void setOutputLimit(size_t limit);
+
+    private:
+        std::mutex output_buffer_mutex;
+        Output output;
+        uint32_t pending_colors;
+        size_t output_limit;
+
+        void append(char const * chars, size_t count);
     };
 };
 
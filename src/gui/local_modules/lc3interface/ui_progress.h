@@ -0,0 +1,58 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#ifndef UI_PROGRESS
+#define UI_PROGRESS
+
+#include <atomic>
+#include <cstdint>
+
+namespace utils
+{
+    // What the UI shows of a run while it goes: the registers as they were between two instructions, and how many
+    // instructions had run by then.
+    struct RunProgress
+    {
+        uint16_t regs[8];
+        uint16_t pc, ir, psr, mcr;
+        uint64_t inst_count;
+    };
+
+    // Hands the latest of a series of values from the simulator's worker thread to the JS thread without either
+    // waiting on the other.  The writer fills a buffer of its own and swaps it with the one in the middle, and the
+    // reader swaps its own with the middle one whenever a newer value is there, so each side only ever sees a whole
+    // value.  Values the reader had no chance to take are replaced.
+    template<typename T>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer(void) : buffers(), back(0), middle(1), front(2) {}
+
+        T & writeBuffer(void) { return buffers[back]; }
+        void publish(void)
+        {
+            back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+        }
+
+        // Returns false if nothing was published since the last call, in which case value is the one taken then.
+        bool take(T const *& value)
+        {
+            bool fresh = (middle.load(std::memory_order_relaxed) & FRESH) != 0;
+            if(fresh) {
+                front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+            }
+            value = &buffers[front];
+            return fresh;
+        }
+
+    private:
+        enum : uint8_t { INDEX = 3, FRESH = 4 };
+
+        T buffers[3];
+        uint8_t back;
+        std::atomic<uint8_t> middle;
+        uint8_t front;
+    };
+};
+
+#endif
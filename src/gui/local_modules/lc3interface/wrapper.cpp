@@ -8,13 +8,16 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #define API_VER 2
 #include "interface.h"
 #include "ui_printer.h"
 #include "ui_inputter.h"
+#include "ui_progress.h"
 
 utils::UIPrinter printer;
 utils::UIInputter inputter;
@@ -25,6 +28,9 @@ std::shared_ptr<lc3::sim> sim = nullptr;
 // (baking the symbol table into the object file is out of my reach)
 lc3::core::SymbolTable currSymTable; 
 bool hit_breakpoint = false;
+// The memory values GetMemRange last returned, by address, to tell which have changed since.
+std::vector<uint16_t> shown_mem(1 << 16);
+std::vector<bool> mem_shown(1 << 16, false);
 
 class SimulatorAsyncWorker : public Nan::AsyncWorker
 {
@@ -61,6 +67,118 @@ public:
     }
 };
 
+// Runs the simulator like SimulatorAsyncWorker, and while it runs, hands the output and a copy of the registers to
+// the progress callback at most once a period.  The simulator thread only publishes a copy and wakes the JS thread,
+// which takes the output and the latest copy once it gets to it, however many were published in the meantime.
+class SimulatorProgressWorker : public Nan::AsyncProgressWorker
+{
+private:
+    // The time is only looked at once an interval, so the period costs next to nothing on top of the run.
+    static constexpr uint64_t PROGRESS_INST_INTERVAL = 1 << 16;
+    static constexpr std::chrono::milliseconds PROGRESS_PERIOD{50};
+
+    std::function<void(void)> run_function;
+    Nan::Callback * progress_callback;
+    utils::TripleBuffer<utils::RunProgress> run_progress;
+    utils::UIPrinter::Output output;
+    // Progress can still be waiting to be handled when the run finishes, by which point it is out of date.
+    bool finished;
+
+    void publishProgress(lc3::sim & sim_inst)
+    {
+        utils::RunProgress & copy = run_progress.writeBuffer();
+        for(uint16_t i = 0; i < 8; i += 1) {
+            copy.regs[i] = sim_inst.readReg(i);
+        }
+        copy.pc = sim_inst.readPC();
+        copy.ir = sim_inst.readMem(copy.pc);
+        copy.psr = sim_inst.readPSR();
+        copy.mcr = sim_inst.readMCR();
+        copy.inst_count = sim_inst.getInstExecCount();
+        run_progress.publish();
+    }
+
+    void callDone(v8::Local<v8::Value> error)
+    {
+        finished = true;
+        v8::Local<v8::Value> argv[] = { error };
+        Nan::Call(callback->GetFunction(), Nan::GetCurrentContext()->Global(), 1, argv);
+    }
+
+public:
+    SimulatorProgressWorker(std::function<void(void)> run_function, Nan::Callback * progress_callback,
+        Nan::Callback * callback) :
+        Nan::AsyncProgressWorker(callback), run_function(run_function), progress_callback(progress_callback),
+        finished(false) {}
+    ~SimulatorProgressWorker(void) { delete progress_callback; }
+
+    void Execute(ExecutionProgress const & progress)
+    {
+        std::chrono::steady_clock::time_point last_progress = std::chrono::steady_clock::now();
+        sim->setProgressListener([this, &progress, &last_progress](lc3::sim & sim_inst) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if(now - last_progress < PROGRESS_PERIOD) { return; }
+            last_progress = now;
+            publishProgress(sim_inst);
+            progress.Signal();
+        }, PROGRESS_INST_INTERVAL);
+
+        try {
+            run_function();
+        } catch(std::exception const & e) {
+            this->SetErrorMessage(e.what());
+        }
+        sim->setProgressListener(nullptr, 0);
+    }
+
+    void HandleProgressCallback(char const * data, size_t count)
+    {
+        (void) data;
+        (void) count;
+        if(finished) { return; }
+
+        Nan::HandleScope scope;
+        printer.takeOutput(output);
+        utils::RunProgress const * copy = nullptr;
+        bool fresh = run_progress.take(copy);
+
+        v8::Local<v8::Value> state = Nan::Null();
+        if(fresh) {
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            for(uint16_t i = 0; i < 8; i += 1) {
+                Nan::Set(obj, Nan::New("r" + std::to_string(i)).ToLocalChecked(), Nan::New<v8::Number>(copy->regs[i]));
+            }
+            Nan::Set(obj, Nan::New("pc").ToLocalChecked(), Nan::New<v8::Number>(copy->pc));
+            Nan::Set(obj, Nan::New("ir").ToLocalChecked(), Nan::New<v8::Number>(copy->ir));
+            Nan::Set(obj, Nan::New("psr").ToLocalChecked(), Nan::New<v8::Number>(copy->psr));
+            Nan::Set(obj, Nan::New("mcr").ToLocalChecked(), Nan::New<v8::Number>(copy->mcr));
+            Nan::Set(obj, Nan::New("inst_count").ToLocalChecked(),
+                Nan::New<v8::Number>(static_cast<double>(copy->inst_count)));
+            state = obj;
+        } else if(output.text.empty() && output.dropped == 0) {
+            return;
+        }
+
+        v8::Local<v8::Value> argv[] = {
+            Nan::New<v8::String>(output.toHTML()).ToLocalChecked(),
+            state
+        };
+        Nan::Call(progress_callback->GetFunction(), Nan::GetCurrentContext()->Global(), 2, argv);
+    }
+
+    void HandleOKCallback(void) {
+        Nan::HandleScope scope;
+        callDone(Nan::Null());
+    }
+
+    void HandleErrorCallback(void) {
+        Nan::HandleScope scope;
+        callDone(Nan::New(this->ErrorMessage()).ToLocalChecked());
+    }
+};
+
+constexpr std::chrono::milliseconds SimulatorProgressWorker::PROGRESS_PERIOD;
+
 NAN_METHOD(Init)
 {
     try {
@@ -270,6 +388,57 @@ NAN_METHOD(RunUntilHalt)
     ));
 }
 
+NAN_METHOD(RunWithProgress)
+{
+    if(info.Length() != 3) {
+        Nan::ThrowError("Requires 3 arguments");
+        return;
+    }
+
+    if(! info[0]->IsString()) {
+        Nan::ThrowError("Must provide run mode as a string argument");
+        return;
+    }
+
+    if(! info[1]->IsFunction() || ! info[2]->IsFunction()) {
+        Nan::ThrowError("Must provide progress and completion callbacks as arguments");
+        return;
+    }
+
+    Nan::Utf8String str(info[0].As<v8::String>());
+    std::string mode((char const *) *str);
+
+    std::function<void(void)> run_function;
+    if(mode == "run") {
+        run_function = []() {
+            sim->setRunInstLimit(0);
+            sim->run();
+        };
+    } else if(mode == "halt") {
+        run_function = []() {
+            sim->setRunInstLimit(0);
+            sim->runUntilHalt();
+            // mock printing the halt message to console when HALT is encountered
+            if (sim->readMem(sim->readPC()) == 0xF025) {
+                printer.print("\n\n--- Halting the LC-3 ---\n\n");
+            }
+        };
+    } else if(mode == "in") {
+        run_function = []() { sim->stepIn(); };
+    } else if(mode == "over") {
+        run_function = []() { sim->stepOver(); };
+    } else if(mode == "out") {
+        run_function = []() { sim->stepOut(); };
+    } else {
+        Nan::ThrowError("Run mode must be one of run, halt, in, over, or out");
+        return;
+    }
+
+    hit_breakpoint = false;
+    Nan::AsyncQueueWorker(new SimulatorProgressWorker(run_function,
+        new Nan::Callback(info[1].As<v8::Function>()), new Nan::Callback(info[2].As<v8::Function>())));
+}
+
 NAN_METHOD(StepIn)
 {
     if(info.Length() != 1) {
@@ -509,6 +678,87 @@ NAN_METHOD(GetMemLine)
     }
 }
 
+// Reads the range in one pass rather than a call per location.  The values are copied, since the memory pages they
+// live in are replaced when written to.  Returns the values, and a bitmap of the locations whose values differ from
+// what the last call returned for them, or that no call has returned yet.
+NAN_METHOD(GetMemRange)
+{
+    if(info.Length() != 2) {
+        Nan::ThrowError("Requires 2 arguments");
+        return;
+    }
+
+    if(! info[0]->IsNumber() || ! info[1]->IsNumber()) {
+        Nan::ThrowError("Must provide start address and count as numerical arguments");
+        return;
+    }
+
+    uint16_t start = static_cast<uint16_t>(Nan::To<uint32_t>(info[0]).FromJust());
+    uint32_t count = Nan::To<uint32_t>(info[1]).FromJust();
+    if(count > (1 << 16)) {
+        Nan::ThrowError("Count must be at most 65536");
+        return;
+    }
+
+    try {
+        v8::Local<v8::ArrayBuffer> value_buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(),
+            count * sizeof(uint16_t));
+        v8::Local<v8::Uint16Array> values = v8::Uint16Array::New(value_buffer, 0, count);
+        v8::Local<v8::ArrayBuffer> dirty_buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), (count + 7) / 8);
+        v8::Local<v8::Uint8Array> dirty = v8::Uint8Array::New(dirty_buffer, 0, (count + 7) / 8);
+
+        Nan::TypedArrayContents<uint16_t> value_data(values);
+        Nan::TypedArrayContents<uint8_t> dirty_data(dirty);
+        sim->readMemRange(start, *value_data, count);
+        std::fill(*dirty_data, *dirty_data + dirty_data.length(), 0);
+        for(uint32_t i = 0; i < count; i += 1) {
+            uint16_t addr = static_cast<uint16_t>(start + i);
+            if(! mem_shown[addr] || shown_mem[addr] != (*value_data)[i]) {
+                (*dirty_data)[i >> 3] |= static_cast<uint8_t>(1 << (i & 7));
+                shown_mem[addr] = (*value_data)[i];
+                mem_shown[addr] = true;
+            }
+        }
+
+        v8::Local<v8::Object> ret = Nan::New<v8::Object>();
+        Nan::Set(ret, Nan::New("values").ToLocalChecked(), values);
+        Nan::Set(ret, Nan::New("dirty").ToLocalChecked(), dirty);
+        info.GetReturnValue().Set(ret);
+    } catch(std::exception const & e) {
+        Nan::ThrowError(e.what());
+    }
+}
+
+NAN_METHOD(GetMemLines)
+{
+    if(info.Length() != 2) {
+        Nan::ThrowError("Requires 2 arguments");
+        return;
+    }
+
+    if(! info[0]->IsNumber() || ! info[1]->IsNumber()) {
+        Nan::ThrowError("Must provide start address and count as numerical arguments");
+        return;
+    }
+
+    uint16_t start = static_cast<uint16_t>(Nan::To<uint32_t>(info[0]).FromJust());
+    uint32_t count = Nan::To<uint32_t>(info[1]).FromJust();
+    if(count > (1 << 16)) {
+        Nan::ThrowError("Count must be at most 65536");
+        return;
+    }
+
+    try {
+        v8::Local<v8::Array> ret = Nan::New<v8::Array>(count);
+        for(uint32_t i = 0; i < count; i += 1) {
+            Nan::Set(ret, i, Nan::New<v8::String>(sim->getMemLine(static_cast<uint16_t>(start + i))).ToLocalChecked());
+        }
+        info.GetReturnValue().Set(ret);
+    } catch(std::exception const & e) {
+        Nan::ThrowError(e.what());
+    }
+}
+
 NAN_METHOD(SetMemLine)
 {
     if(info.Length() != 2) {
@@ -589,11 +839,12 @@ NAN_METHOD(AddInput)
 
 NAN_METHOD(GetAndClearOutput)
 {
+    // Only the JS thread takes output, so the buffer it was taken into can be kept for the next time.
+    static utils::UIPrinter::Output output;
+
     try {
-        std::vector<std::string> const & output = printer.getAndClearOutputBuffer();
-        std::string joined = "";
-        for(std::string const & str : output) { joined += str; }
-        auto ret = Nan::New<v8::String>(joined).ToLocalChecked();
+        printer.takeOutput(output);
+        auto ret = Nan::New<v8::String>(output.toHTML()).ToLocalChecked();
         info.GetReturnValue().Set(ret);
     } catch(std::exception const & e) {
         Nan::ThrowError(e.what());
@@ -609,21 +860,74 @@ NAN_METHOD(ClearOutput)
     }
 }
 
-NAN_METHOD(SetBreakpoint)
+NAN_METHOD(SetOutputLimit)
 {
     if(info.Length() != 1) {
         Nan::ThrowError("Requires 1 argument");
         return;
     }
 
+    if(! info[0]->IsNumber()) {
+        Nan::ThrowError("Must provide limit as a number argument");
+        return;
+    }
+
+    printer.setOutputLimit(static_cast<size_t>(Nan::To<uint32_t>(info[0]).FromJust()));
+}
+
+// Reads the optional condition string and number of hits to skip that follow the address arguments of
+// SetBreakpoint and SetWatchpoint.  Throws and returns false if they are malformed.
+static bool getBreakOptions(Nan::FunctionCallbackInfo<v8::Value> const & info, int first,
+    lc3::core::BreakCondition & condition, uint64_t & ignore_count)
+{
+    if(info.Length() > first && ! info[first]->IsUndefined()) {
+        if(! info[first]->IsString()) {
+            Nan::ThrowError("Must provide condition as a string argument");
+            return false;
+        }
+
+        Nan::Utf8String str(info[first].As<v8::String>());
+        lc3::optional<lc3::core::BreakCondition> parsed =
+            lc3::core::BreakCondition::parse(std::string((char const *) (*str)));
+        if(! parsed) {
+            Nan::ThrowError("Invalid condition");
+            return false;
+        }
+        condition = *parsed;
+    }
+
+    if(info.Length() > first + 1 && ! info[first + 1]->IsUndefined()) {
+        if(! info[first + 1]->IsNumber()) {
+            Nan::ThrowError("Must provide number of hits to skip as a numerical argument");
+            return false;
+        }
+        ignore_count = Nan::To<uint32_t>(info[first + 1]).FromJust();
+    }
+
+    return true;
+}
+
+NAN_METHOD(SetBreakpoint)
+{
+    if(info.Length() < 1 || info.Length() > 3) {
+        Nan::ThrowError("Requires 1 to 3 arguments");
+        return;
+    }
+
     if(! info[0]->IsNumber()) {
         Nan::ThrowError("Must provide memory address as a numerical argument");
         return;
     }
 
     uint32_t addr = Nan::To<uint32_t>(info[0]).FromJust();
+    lc3::core::BreakCondition condition;
+    uint64_t ignore_count = 0;
+    if(! getBreakOptions(info, 1, condition, ignore_count)) {
+        return;
+    }
+
     try {
-        sim->setBreakpoint(addr);
+        sim->setBreakpoint(addr, condition, ignore_count);
     } catch(std::exception const & e) {
         Nan::ThrowError(e.what());
     }
@@ -649,6 +953,136 @@ NAN_METHOD(RemoveBreakpoint)
     }
 }
 
+NAN_METHOD(GetBreakpointHitCount)
+{
+    if(info.Length() != 1) {
+        Nan::ThrowError("Requires 1 argument");
+        return;
+    }
+
+    if(! info[0]->IsNumber()) {
+        Nan::ThrowError("Must provide memory address as a numerical argument");
+        return;
+    }
+
+    uint32_t addr = Nan::To<uint32_t>(info[0]).FromJust();
+    try {
+        auto ret = Nan::New<v8::Number>(sim->getBreakpointHitCount(addr));
+        info.GetReturnValue().Set(ret);
+    } catch(std::exception const & e) {
+        Nan::ThrowError(e.what());
+    }
+}
+
+NAN_METHOD(SetWatchpoint)
+{
+    if(info.Length() < 3 || info.Length() > 5) {
+        Nan::ThrowError("Requires 3 to 5 arguments");
+        return;
+    }
+
+    if(! info[0]->IsNumber() || ! info[1]->IsNumber()) {
+        Nan::ThrowError("Must provide memory addresses as numerical arguments");
+        return;
+    }
+
+    if(! info[2]->IsString()) {
+        Nan::ThrowError("Must provide type as a string argument");
+        return;
+    }
+
+    uint32_t start = Nan::To<uint32_t>(info[0]).FromJust();
+    uint32_t end = Nan::To<uint32_t>(info[1]).FromJust();
+    Nan::Utf8String type_str(info[2].As<v8::String>());
+    std::string type_s((char const *) (*type_str));
+    lc3::core::WatchType type;
+    if(type_s == "read") {
+        type = lc3::core::WatchType::READ;
+    } else if(type_s == "write") {
+        type = lc3::core::WatchType::WRITE;
+    } else if(type_s == "access") {
+        type = lc3::core::WatchType::ACCESS;
+    } else {
+        Nan::ThrowError("Type must be one of read, write, or access");
+        return;
+    }
+
+    lc3::core::BreakCondition condition;
+    uint64_t ignore_count = 0;
+    if(! getBreakOptions(info, 3, condition, ignore_count)) {
+        return;
+    }
+
+    try {
+        auto ret = Nan::New<v8::Number>(sim->setWatchpoint(start, end, type, condition, ignore_count));
+        info.GetReturnValue().Set(ret);
+    } catch(std::exception const & e) {
+        Nan::ThrowError(e.what());
+    }
+}
+
+NAN_METHOD(RemoveWatchpoint)
+{
+    if(info.Length() != 1) {
+        Nan::ThrowError("Requires 1 argument");
+        return;
+    }
+
+    if(! info[0]->IsNumber()) {
+        Nan::ThrowError("Must provide watchpoint ID as a numerical argument");
+        return;
+    }
+
+    uint32_t id = Nan::To<uint32_t>(info[0]).FromJust();
+    try {
+        sim->removeWatchpoint(id);
+    } catch(std::exception const & e) {
+        Nan::ThrowError(e.what());
+    }
+}
+
+NAN_METHOD(GetWatchpointHitCount)
+{
+    if(info.Length() != 1) {
+        Nan::ThrowError("Requires 1 argument");
+        return;
+    }
+
+    if(! info[0]->IsNumber()) {
+        Nan::ThrowError("Must provide watchpoint ID as a numerical argument");
+        return;
+    }
+
+    uint32_t id = Nan::To<uint32_t>(info[0]).FromJust();
+    try {
+        auto ret = Nan::New<v8::Number>(sim->getWatchpointHitCount(id));
+        info.GetReturnValue().Set(ret);
+    } catch(std::exception const & e) {
+        Nan::ThrowError(e.what());
+    }
+}
+
+// Describes what stopped the last run as { kind, pc, id, addr, write }, where kind is "none", "breakpoint", or
+// "watchpoint", and the rest only apply to watchpoints other than pc.
+NAN_METHOD(GetLastBreak)
+{
+    try {
+        lc3::core::BreakHit const & hit = sim->getLastBreak();
+        char const * kind = hit.kind == lc3::core::BreakHit::Kind::BREAKPOINT ? "breakpoint" :
+            (hit.kind == lc3::core::BreakHit::Kind::WATCHPOINT ? "watchpoint" : "none");
+
+        v8::Local<v8::Object> ret = Nan::New<v8::Object>();
+        Nan::Set(ret, Nan::New("kind").ToLocalChecked(), Nan::New(kind).ToLocalChecked());
+        Nan::Set(ret, Nan::New("pc").ToLocalChecked(), Nan::New<v8::Number>(hit.pc));
+        Nan::Set(ret, Nan::New("id").ToLocalChecked(), Nan::New<v8::Number>(hit.watch_id));
+        Nan::Set(ret, Nan::New("addr").ToLocalChecked(), Nan::New<v8::Number>(hit.addr));
+        Nan::Set(ret, Nan::New("write").ToLocalChecked(), Nan::New<v8::Boolean>(hit.write));
+        info.GetReturnValue().Set(ret);
+    } catch(std::exception const & e) {
+        Nan::ThrowError(e.what());
+    }
+}
+
 NAN_METHOD(GetInstExecCount)
 {
     try {
@@ -685,6 +1119,7 @@ NAN_MODULE_INIT(NanInit)
 
     NAN_EXPORT(target, Run);
     NAN_EXPORT(target, RunUntilHalt);
+    NAN_EXPORT(target, RunWithProgress);
     NAN_EXPORT(target, StepIn);
     NAN_EXPORT(target, StepOver);
     NAN_EXPORT(target, StepOut);
@@ -696,15 +1131,23 @@ NAN_MODULE_INIT(NanInit)
     NAN_EXPORT(target, SetMemValue);
     NAN_EXPORT(target, GetMemLine);
     NAN_EXPORT(target, SetMemLine);
+    NAN_EXPORT(target, GetMemRange);
+    NAN_EXPORT(target, GetMemLines);
     NAN_EXPORT(target, SetIgnorePrivilege);
 
     NAN_EXPORT(target, ClearInput);
     NAN_EXPORT(target, AddInput);
     NAN_EXPORT(target, GetAndClearOutput);
     NAN_EXPORT(target, ClearOutput);
+    NAN_EXPORT(target, SetOutputLimit);
 
     NAN_EXPORT(target, SetBreakpoint);
     NAN_EXPORT(target, RemoveBreakpoint);
+    NAN_EXPORT(target, GetBreakpointHitCount);
+    NAN_EXPORT(target, SetWatchpoint);
+    NAN_EXPORT(target, RemoveWatchpoint);
+    NAN_EXPORT(target, GetWatchpointHitCount);
+    NAN_EXPORT(target, GetLastBreak);
 
     NAN_EXPORT(target, GetInstExecCount);
     NAN_EXPORT(target, DidHitBreakpoint);
@@ -716,74 +1159,123 @@ void utils::UIPrinter::setColor(lc3::utils::PrintColor color)
 {
     using namespace lc3::utils;
 
+    std::lock_guard<std::mutex> const lock(output_buffer_mutex);
     if(color == PrintColor::RESET) {
         while(pending_colors != 0) {
-            output_buffer.push_back("</span>");
+            output.tags.emplace_back(output.text.size(), "</span>");
             pending_colors -= 1;
         }
-    } else {
-        std::string format = "<span class=\"text-";
+    } else if(output.dropped == 0) {
+        // Text that is dropped needs no color, and leaving the tag out keeps the tags that were kept balanced.
+        char const * tag = nullptr;
         switch(color)
         {
-            case PrintColor::RED      : format += "red"    ; break;
-            case PrintColor::YELLOW   : format += "yellow" ; break;
-            case PrintColor::GREEN    : format += "green"  ; break;
-            case PrintColor::MAGENTA  : format += "magenta"; break;
-            case PrintColor::BLUE     : format += "blue"   ; break;
-            case PrintColor::GRAY     : format += "gray"   ; break;
-            case PrintColor::BOLD     : format += "bold"   ; break;
-            default                   : break;
+            case PrintColor::RED      : tag = "<span class=\"text-red\">"    ; break;
+            case PrintColor::YELLOW   : tag = "<span class=\"text-yellow\">" ; break;
+            case PrintColor::GREEN    : tag = "<span class=\"text-green\">"  ; break;
+            case PrintColor::MAGENTA  : tag = "<span class=\"text-magenta\">"; break;
+            case PrintColor::BLUE     : tag = "<span class=\"text-blue\">"   ; break;
+            case PrintColor::GRAY     : tag = "<span class=\"text-gray\">"   ; break;
+            case PrintColor::BOLD     : tag = "<span class=\"text-bold\">"   ; break;
+            default                   : tag = "<span class=\"text-\">"       ; break;
         }
-        format += "\">";
-        output_buffer.push_back(format);
+        output.tags.emplace_back(output.text.size(), tag);
         pending_colors += 1;
     }
 }
 
-std::vector<std::string> utils::UIPrinter::getAndClearOutputBuffer(void)
+void utils::UIPrinter::takeOutput(Output & taken)
 {
+    taken.clear();
     std::lock_guard<std::mutex> const lock(output_buffer_mutex);
-    std::vector<std::string> output_buffer_copy = output_buffer;
-    output_buffer.clear();
-    return output_buffer_copy;
+    std::swap(output, taken);
 }
 
 void utils::UIPrinter::clearOutputBuffer(void)
 {
     std::lock_guard<std::mutex> const lock(output_buffer_mutex);
-    output_buffer.clear();
+    output.clear();
+}
+
+void utils::UIPrinter::setOutputLimit(size_t limit)
+{
+    std::lock_guard<std::mutex> const lock(output_buffer_mutex);
+    output_limit = limit;
 }
 
 void utils::UIPrinter::print(std::string const & string)
 {
     std::lock_guard<std::mutex> const lock(output_buffer_mutex);
-    output_buffer.push_back(string);
+    append(string.data(), string.size());
+}
+
+void utils::UIPrinter::printChars(char const * chars, size_t count)
+{
+    std::lock_guard<std::mutex> const lock(output_buffer_mutex);
+    append(chars, count);
 }
 
 void utils::UIPrinter::newline(void)
 {
     std::lock_guard<std::mutex> const lock(output_buffer_mutex);
-    output_buffer.push_back("\n");
+    append("\n", 1);
+}
+
+void utils::UIPrinter::append(char const * chars, size_t count)
+{
+    size_t const room = output.text.size() < output_limit ? output_limit - output.text.size() : 0;
+    size_t const kept = std::min(count, room);
+    output.text.append(chars, kept);
+    output.dropped += count - kept;
+}
+
+std::string utils::UIPrinter::Output::toHTML(void) const
+{
+    std::string html;
+    html.reserve(text.size() + tags.size() * 32);
+    size_t offset = 0;
+    for(std::pair<size_t, char const *> const & tag : tags) {
+        html.append(text, offset, tag.first - offset);
+        html += tag.second;
+        offset = tag.first;
+    }
+    html.append(text, offset, std::string::npos);
+    if(dropped != 0) {
+        html += "\n<span class=\"text-gray\">[" + std::to_string(dropped) +
+            " more characters of output were dropped]</span>\n";
+    }
+    return html;
 }
 
 bool utils::UIInputter::getChar(char & c)
 {
-    std::lock_guard<std::mutex> const lock(buffer_mutex);
-    if(buffer.empty()) { return false; }
+    uint64_t const cleared_count = cleared.load(std::memory_order_acquire);
+    while(taken < cleared_count && buffer.pop(c)) {
+        taken += 1;
+    }
 
-    c = buffer.front();
-    buffer.erase(buffer.begin());
+    if(! buffer.pop(c)) { return false; }
+    taken += 1;
     return true;
 }
 
 void utils::UIInputter::clearInput(void)
 {
-    std::lock_guard<std::mutex> const lock(buffer_mutex);
-    buffer.clear();
+    cleared.store(added, std::memory_order_release);
 }
 
 void utils::UIInputter::addInput(char c)
 {
-    std::lock_guard<std::mutex> const lock(buffer_mutex);
-    buffer.push_back(c);
+    // Keystrokes that don't fit are dropped, as the keyboard would if nobody read it.
+    if(! buffer.push(c)) { return; }
+    added += 1;
+
+    std::lock_guard<std::mutex> const lock(listener_mutex);
+    if(listener) { listener(); }
+}
+
+void utils::UIInputter::setInputListener(std::function<void(void)> listener)
+{
+    std::lock_guard<std::mutex> const lock(listener_mutex);
+    this->listener = listener;
 }
@@ -0,0 +1,60 @@
+# Feeds break commands to the command-line simulator and checks what it makes of each.  Nothing is run, so the
+# console inputter never competes with the prompt for stdin.
+#
+#   cmake -DSIMULATOR=<path to simulator> -DWORK_DIR=<scratch directory> -P break_cli.cmake
+
+set(COMMANDS
+    "break watch 0x3100"
+    "break watch 0x3100 0x3101"
+    "break watch 0x3100 write"
+    "break watch 0x3102 0x3100 read"
+    "break watch 0x3100 skip 2"
+    "break watch 0x3100 0x3104 access skip 1 if R0 == x10"
+    "break watch 0x3100 if MEM[x3100] < #0"
+    "break watch 0xFE00"
+    "break watch 0x3100 0xFE04"
+    "break watch 0x3100 bogus"
+    "break watch 0x3100 skip"
+    "break watch 0x3100 if R9 == 1"
+    "break watch"
+    "break set 0x3000 if r10==1"
+    "break set 0x3000 skip 3 if PC >= x3000"
+    "break clear 1"
+    "break list"
+    "quit"
+)
+string(REPLACE ";" "\n" INPUT "${COMMANDS}")
+file(WRITE "${WORK_DIR}/break_cli.txt" "${INPUT}\n")
+
+execute_process(COMMAND "${SIMULATOR}" INPUT_FILE "${WORK_DIR}/break_cli.txt" OUTPUT_VARIABLE OUTPUT
+    RESULT_VARIABLE RESULT TIMEOUT 60)
+if(NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "simulator exited with ${RESULT}:\n${OUTPUT}")
+endif()
+
+set(EXPECTED
+    "#0: watch access 0x3100\n"
+    "#1: watch access 0x3100-0x3101\n"
+    "#2: watch write 0x3100\n"
+    "#3: watch read 0x3100-0x3102\n"
+    "#4: watch access 0x3100 skip 2\n"
+    "#5: watch access 0x3100-0x3104 if R0 == 0x0010 skip 1\n"
+    "#6: watch access 0x3100 if MEM[0x3100] < 0x0000\n"
+    "> cannot watch device registers\nExecuted 0 instructions\n> cannot watch device registers\n"
+    "unknown option\n"
+    "must supply number of hits to skip\n"
+    "> invalid condition\nExecuted 0 instructions\n> must supply start address\n"
+    "Executed 0 instructions\n> invalid condition\n"
+    "if PC >= 0x3000 skip 3\n"
+    "#0: watch access 0x3100 (hits: 0)\n#2: watch write 0x3100 (hits: 0)\n#3: watch read 0x3100-0x3102 (hits: 0)\n"
+)
+foreach(LINE IN LISTS EXPECTED)
+    string(FIND "${OUTPUT}" "${LINE}" POS)
+    if(POS EQUAL -1)
+        message(SEND_ERROR "missing from the output: ${LINE}")
+        set(FAILED TRUE)
+    endif()
+endforeach()
+if(FAILED)
+    message(FATAL_ERROR "simulator output:\n${OUTPUT}")
+endif()
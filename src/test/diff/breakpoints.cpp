@@ -0,0 +1,260 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <cinttypes>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+
+#include "breakpoint.h"
+#include "inputter.h"
+#include "interface.h"
+#include "printer.h"
+
+// Parses break conditions, then runs small programs under conditional breakpoints and under read, write, and access
+// watchpoints on every kind of load and store, checking where each run stops and what it reports as having stopped
+// it.
+
+using lc3::core::BreakCondition;
+using lc3::core::BreakHit;
+using lc3::core::WatchType;
+
+static uint32_t failures = 0;
+
+static void check(char const * what, uint64_t expected, uint64_t actual)
+{
+    if(expected != actual) {
+        std::printf("  %s: expected 0x%04" PRIx64 ", got 0x%04" PRIx64 "\n", what, expected, actual);
+        failures += 1;
+    }
+}
+
+static void checkParse(char const * str, bool accepted,
+    BreakCondition::Operand operand = BreakCondition::Operand::NONE, uint16_t index = 0,
+    BreakCondition::Compare compare = BreakCondition::Compare::EQ, uint16_t value = 0)
+{
+    lc3::optional<BreakCondition> condition = BreakCondition::parse(str);
+    if(static_cast<bool>(condition) != accepted) {
+        std::printf("  \"%s\": expected to be %s\n", str, accepted ? "accepted" : "rejected");
+        failures += 1;
+        return;
+    }
+    if(! condition) { return; }
+
+    if(condition->operand != operand || condition->index != index || condition->compare != compare ||
+        condition->value != value)
+    {
+        std::printf("  \"%s\": parsed as \"%s\"\n", str, condition->toString().c_str());
+        failures += 1;
+    }
+}
+
+static void parse(void)
+{
+    using Operand = BreakCondition::Operand;
+    using Compare = BreakCondition::Compare;
+
+    checkParse("", true);
+    checkParse("R0==x10", true, Operand::REG, 0, Compare::EQ, 0x10);
+    checkParse("r7 != #-1", true, Operand::REG, 7, Compare::NE, 0xFFFF);
+    checkParse("R3 = 0x7FFF", true, Operand::REG, 3, Compare::EQ, 0x7FFF);
+    checkParse("mem[x4000]<#0", true, Operand::MEM, 0x4000, Compare::LT, 0);
+    checkParse("MEM[0x4000] >= -x10", true, Operand::MEM, 0x4000, Compare::GE, 0xFFF0);
+    checkParse("PC <= xFDFF", true, Operand::PC, 0, Compare::LE, 0xFDFF);
+    checkParse("pc > 12288", true, Operand::PC, 0, Compare::GT, 0x3000);
+
+    checkParse("r10==1", false);
+    checkParse("R8 == 1", false);
+    checkParse("MEM[xFE00]==0", false);
+    checkParse("MEM[x4000 == 0", false);
+    checkParse("R0 x10", false);
+    checkParse("R0 ==", false);
+    checkParse("R0 == x10000", false);
+    checkParse("R0 == -x8001", false);
+    checkParse("R0 == 1z", false);
+}
+
+// Counts R3 down from 5 to 0, decrementing R0 from 0 alongside it.
+static void loadLoop(lc3::sim & simulator)
+{
+    static uint16_t const program[] = {
+        0x103F,     // x3000  LOOP ADD R0, R0, #-1
+        0x16FF,     // x3001  ADD R3, R3, #-1
+        0x03FD,     // x3002  BRp LOOP
+        0xF025,     // x3003  HALT
+    };
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); i += 1) {
+        simulator.writeMem(0x3000 + i, program[i]);
+    }
+    simulator.writeReg(0, 0);
+    simulator.writeReg(3, 5);
+    simulator.writePC(0x3000);
+}
+
+static void breakpoints(lc3::utils::IPrinter & printer, lc3::utils::IInputter & inputter)
+{
+    {
+        lc3::sim simulator(printer, inputter, 0);
+        loadLoop(simulator);
+        simulator.setBreakpoint(0x3001);
+        simulator.runUntilHalt();
+        check("PC at breakpoint", 0x3001, simulator.readPC());
+        check("break kind", static_cast<uint64_t>(BreakHit::Kind::BREAKPOINT),
+            static_cast<uint64_t>(simulator.getLastBreak().kind));
+        check("break PC", 0x3001, simulator.getLastBreak().pc);
+
+        // Resuming from the breakpoint runs through it rather than stopping straight away.
+        simulator.runUntilHalt();
+        check("R3 at second hit", 4, simulator.readReg(3));
+        check("breakpoint hits", 2, simulator.getBreakpointHitCount(0x3001));
+        simulator.removeBreakpoint(0x3001);
+        simulator.runUntilHalt();
+        check("R3 after removing breakpoint", 0, simulator.readReg(3));
+    }
+
+    // Registers are compared as signed values: R0 goes -1, -2, -3, ..., which as unsigned values are never below #1.
+    {
+        lc3::sim simulator(printer, inputter, 0);
+        loadLoop(simulator);
+        simulator.setBreakpoint(0x3001, *BreakCondition::parse("R0 < #1"));
+        simulator.runUntilHalt();
+        check("R0 at signed breakpoint", 0xFFFF, simulator.readReg(0));
+    }
+
+    // Only hits with the condition holding count towards the ones skipped.
+    {
+        lc3::sim simulator(printer, inputter, 0);
+        loadLoop(simulator);
+        simulator.setBreakpoint(0x3001, *BreakCondition::parse("R0 < #-2"), 1);
+        simulator.runUntilHalt();
+        check("R0 at skipped breakpoint", 0xFFFC, simulator.readReg(0));
+        check("skipped breakpoint hits", 2, simulator.getBreakpointHitCount(0x3001));
+    }
+
+    // Memory is compared as a signed value too, and the PC as an unsigned one, so neither of these stops.
+    {
+        lc3::sim simulator(printer, inputter, 0);
+        loadLoop(simulator);
+        simulator.writeMem(0x4000, 0xFFFF);
+        simulator.setBreakpoint(0x3001, *BreakCondition::parse("MEM[x4000] > #0"));
+        simulator.setBreakpoint(0x3002, *BreakCondition::parse("PC < x0000"));
+        simulator.runUntilHalt();
+        check("PC with conditions that never hold", 0x3003, simulator.readPC());
+
+        loadLoop(simulator);
+        simulator.setBreakpoint(0x3001, *BreakCondition::parse("MEM[x4000] < #0"));
+        simulator.runUntilHalt();
+        check("PC at signed memory breakpoint", 0x3001, simulator.readPC());
+
+        loadLoop(simulator);
+        simulator.removeBreakpoint(0x3001);
+        simulator.setBreakpoint(0x3002, *BreakCondition::parse("PC < x8000"));
+        simulator.runUntilHalt();
+        check("PC at unsigned PC breakpoint", 0x3002, simulator.readPC());
+    }
+}
+
+// Loads x3100 and stores it back, once directly and once through the pointer at x3008.
+static void loadAccesses(lc3::sim & simulator)
+{
+    static uint16_t const program[] = {
+        0x6040,     // x3000  LDR R0, R1, #0
+        0x7040,     // x3001  STR R0, R1, #0
+        0xA405,     // x3002  LDI R2, PTR
+        0xB404,     // x3003  STI R2, PTR
+        0xF025,     // x3004  HALT
+        0x0000,     // x3005
+        0x0000,     // x3006
+        0x0000,     // x3007
+        0x3100,     // x3008  PTR .FILL x3100
+    };
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); i += 1) {
+        simulator.writeMem(0x3000 + i, program[i]);
+    }
+    simulator.writeMem(0x3100, 0x1234);
+    simulator.writeReg(1, 0x3100);
+    simulator.writePC(0x3000);
+}
+
+struct ExpectedHit
+{
+    uint16_t pc;
+    uint16_t addr;
+    bool write;
+};
+
+// Runs the accesses program under one watchpoint, which must stop it after exactly the expected instructions.
+static void watch(lc3::utils::IPrinter & printer, lc3::utils::IInputter & inputter, char const * name,
+    uint16_t start, uint16_t end, WatchType type, uint64_t ignore_count, std::initializer_list<ExpectedHit> expected)
+{
+    lc3::sim simulator(printer, inputter, 0);
+    loadAccesses(simulator);
+    uint32_t id = simulator.setWatchpoint(start, end, type, BreakCondition(), ignore_count);
+
+    for(ExpectedHit const & hit : expected) {
+        simulator.runUntilHalt();
+        BreakHit const & last = simulator.getLastBreak();
+        if(last.kind != BreakHit::Kind::WATCHPOINT || last.pc != hit.pc) {
+            std::printf("  %s: expected a stop after 0x%04X, stopped at 0x%04X\n", name, hit.pc, simulator.readPC());
+            failures += 1;
+            return;
+        }
+        check("PC after watched instruction", hit.pc + 1, simulator.readPC());
+        check("watch ID", id, last.watch_id);
+        check("watched address", hit.addr, last.addr);
+        check("watched write", hit.write, last.write);
+    }
+
+    simulator.runUntilHalt();
+    if(simulator.getLastBreak().kind != BreakHit::Kind::NONE) {
+        std::printf("  %s: unexpected stop after 0x%04X\n", name, simulator.getLastBreak().pc);
+        failures += 1;
+    }
+    check("PC at HALT", 0x3004, simulator.readPC());
+    check("watchpoint hits", ignore_count + expected.size(), simulator.getWatchpointHitCount(id));
+}
+
+static void watchpoints(lc3::utils::IPrinter & printer, lc3::utils::IInputter & inputter)
+{
+    watch(printer, inputter, "read", 0x3100, 0x3100, WatchType::READ, 0,
+        { { 0x3000, 0x3100, false }, { 0x3002, 0x3100, false } });
+    watch(printer, inputter, "write", 0x3100, 0x3100, WatchType::WRITE, 0,
+        { { 0x3001, 0x3100, true }, { 0x3003, 0x3100, true } });
+    watch(printer, inputter, "access", 0x3100, 0x3100, WatchType::ACCESS, 0,
+        { { 0x3000, 0x3100, false }, { 0x3001, 0x3100, true }, { 0x3002, 0x3100, false },
+          { 0x3003, 0x3100, true } });
+    watch(printer, inputter, "access skip 2", 0x3100, 0x3100, WatchType::ACCESS, 2,
+        { { 0x3002, 0x3100, false }, { 0x3003, 0x3100, true } });
+    // LDI and STI both read the pointer, and a range covers every address in it.
+    watch(printer, inputter, "pointer read", 0x3008, 0x3008, WatchType::READ, 0,
+        { { 0x3002, 0x3008, false }, { 0x3003, 0x3008, false } });
+    watch(printer, inputter, "pointer write", 0x3008, 0x3008, WatchType::WRITE, 0, {});
+    watch(printer, inputter, "range write", 0x3050, 0x3200, WatchType::WRITE, 0,
+        { { 0x3001, 0x3100, true }, { 0x3003, 0x3100, true } });
+
+    // A condition is checked after the instruction, so the store of R0 + 1 stops where the store of R0 would not.
+    {
+        lc3::sim simulator(printer, inputter, 0);
+        loadAccesses(simulator);
+        simulator.writeMem(0x3001, 0x1021);     // ADD R0, R0, #1
+        simulator.writeMem(0x3002, 0x7040);     // STR R0, R1, #0
+        uint32_t id = simulator.setWatchpoint(0x3100, 0x3100, WatchType::WRITE,
+            *BreakCondition::parse("MEM[x3100] == x1235"));
+        simulator.runUntilHalt();
+        check("PC after conditional watchpoint", 0x3003, simulator.readPC());
+        check("conditional watchpoint hits", 1, simulator.getWatchpointHitCount(id));
+    }
+}
+
+int main(void)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+
+    parse();
+    breakpoints(printer, inputter);
+    watchpoints(printer, inputter);
+
+    std::printf("%u failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "device_regs.h"
+#include "inputter.h"
+#include "printer.h"
+#include "simulator.h"
+
+// Differential test for the JIT engine.  Random looping programs, mixing register, memory and branch instructions
+// with device register accesses, access violations and stores into their own code, are run on the functional engine
+// and on the JIT engine.  Both must stop after the same number of instructions with the same machine state, both when
+// the programs run to the end and when they are cut off part way through.  Some of the programs branch into system
+// space; of those, some first run in system mode, so that the block there is compiled, and are then run again in user
+// mode, where branching to it must raise an access violation.
+
+static constexpr uint16_t CODE = 0x3000;
+static constexpr uint16_t SUBROUTINE = 0x3030;
+static constexpr uint16_t POOL = 0x3040;
+static constexpr uint16_t POOL_SIZE = 0x80;
+static constexpr uint16_t DATA = 0x4000;
+static constexpr uint16_t DATA_SIZE = 0x100;
+static constexpr uint16_t HANDLER = 0x1000;
+static constexpr uint16_t SYSTEM_BLOCK = 0x2FF0;
+static constexpr uint64_t INST_LIMIT = 20000;
+static constexpr uint32_t CUT_POINTS = 3;
+
+struct Program
+{
+    std::vector<std::pair<uint16_t, uint16_t>> mem;
+    uint16_t regs[8];
+    uint16_t psr;
+    bool ignore_privilege;
+    // Run in system mode first, then again from the start in user mode.
+    bool drop_privilege;
+};
+
+static uint16_t pcOffset(uint16_t pc, uint16_t target, uint32_t width)
+{
+    return static_cast<uint16_t>(target - (pc + 1)) & ((1 << width) - 1);
+}
+
+static Program generate(std::mt19937 & rng)
+{
+    Program program;
+    auto rand = [&rng](uint32_t n) { return static_cast<uint16_t>(rng() % n); };
+    auto emit = [&program](uint16_t addr, uint16_t value) { program.mem.emplace_back(addr, value); };
+
+    // Every trap and exception ends up at a handler that stops the machine.
+    for(uint16_t addr = 0x0000; addr <= 0x01FF; addr += 1) {
+        emit(addr, HANDLER);
+    }
+    emit(HANDLER, 0x5020);                                          // AND R0, R0, #0
+    emit(HANDLER + 1, 0xB000 | pcOffset(HANDLER + 1, HANDLER + 3, 9));   // STI R0, MCR pointer
+    emit(HANDLER + 2, 0x0FFF);                                      // BRnzp #-1
+    emit(HANDLER + 3, MCR);
+
+    uint16_t const body = 2 + rand(24);
+    std::vector<uint16_t> code;
+    for(uint16_t i = 0; i < body; i += 1) {
+        uint16_t pc = CODE + i;
+        uint16_t dr = rand(6) << 9;
+        uint16_t sr1 = rand(8) << 6;
+        uint16_t base = (1 + rand(3)) << 6;
+        uint16_t pool = pcOffset(pc, POOL + 3 + rand(POOL_SIZE - 4), 9);
+        uint16_t kind = rand(100);
+        uint16_t inst;
+        if(kind < 25) {
+            inst = 0x1000 | dr | sr1 | (rand(2) ? (0x20 | rand(32)) : rand(8));
+        } else if(kind < 35) {
+            inst = 0x5000 | dr | sr1 | (rand(2) ? (0x20 | rand(32)) : rand(8));
+        } else if(kind < 40) {
+            inst = 0x903F | dr | sr1;
+        } else if(kind < 45) {
+            inst = 0xE000 | dr | pool;
+        } else if(kind < 55) {
+            inst = 0x2000 | dr | pool;
+        } else if(kind < 63) {
+            inst = 0x6000 | dr | base | rand(64);
+        } else if(kind < 68) {
+            inst = 0xA000 | dr | pool;
+        } else if(kind < 75) {
+            inst = 0x3000 | (rand(8) << 9) | pool;
+        } else if(kind < 83) {
+            inst = 0x7000 | (rand(8) << 9) | base | rand(64);
+        } else if(kind < 87) {
+            inst = 0xB000 | (rand(8) << 9) | pool;
+        } else if(kind < 97) {
+            inst = (rand(8) << 9) | pcOffset(pc, CODE + i + 1 + rand(body - i), 9);
+        } else {
+            inst = 0x4800 | pcOffset(pc, SUBROUTINE, 11);
+        }
+        code.push_back(inst);
+    }
+
+    // A quarter of the programs branch into a block in system space on every iteration, which branches back further
+    // on in the code.
+    bool const cross = body >= 3 && rand(4) == 0;
+    if(cross) {
+        uint16_t back = 1 + rand(body - 1);
+        uint16_t from = rand(back);
+        code[from] = 0x0E00 | pcOffset(CODE + from, SYSTEM_BLOCK, 9);                     // BRnzp SYSTEM_BLOCK
+        emit(SYSTEM_BLOCK, 0x1B61);                                                     // ADD R5, R5, #1
+        emit(SYSTEM_BLOCK + 1, 0x0E00 | pcOffset(SYSTEM_BLOCK + 1, CODE + back, 9));     // BRnzp back
+    }
+
+    // Half of the other programs store into a data word on every iteration until, part way through, the pointer is
+    // moved to one of their own instructions.  By then the store is running natively.
+    uint16_t const counter = 20 + rand(40);
+    if(! cross && body >= 7 && rand(2) == 0) {
+        uint16_t patch = rand(body - 6);
+        uint16_t target = rand(body - 6);
+        target += target >= patch ? 6 : 0;
+        code[patch] = 0x19A0 | ((0x20 - (1 + rand(10))) & 0x1F);                // ADD R4, R6, #-k
+        code[patch + 1] = 0x0A02;                                               // BRnp #2
+        code[patch + 2] = 0x2800 | pcOffset(CODE + patch + 2, POOL + 2, 9);     // LD R4, target
+        code[patch + 3] = 0x3800 | pcOffset(CODE + patch + 3, POOL + 1, 9);     // ST R4, pointer
+        code[patch + 4] = 0x2800 | pcOffset(CODE + patch + 4, POOL, 9);         // LD R4, replacement
+        code[patch + 5] = 0xB800 | pcOffset(CODE + patch + 5, POOL + 1, 9);     // STI R4, pointer
+        emit(POOL, 0x1020 | (rand(6) << 9) | (rand(8) << 6) | rand(32));        // ADD Rx, Ry, #imm5
+        emit(POOL + 1, DATA + rand(DATA_SIZE));
+        emit(POOL + 2, CODE + target);
+    } else {
+        emit(POOL, static_cast<uint16_t>(rng()));
+        emit(POOL + 1, DATA + rand(DATA_SIZE));
+        emit(POOL + 2, DATA + rand(DATA_SIZE));
+    }
+    for(uint16_t i = 0; i < body; i += 1) {
+        emit(CODE + i, code[i]);
+    }
+
+    uint16_t pc = CODE + body;
+    emit(pc, 0x1DBF);                                               // ADD R6, R6, #-1
+    emit(pc + 1, 0x0200 | pcOffset(pc + 1, CODE, 9));               // BRp CODE
+    emit(pc + 2, 0x5020);                                           // AND R0, R0, #0
+    emit(pc + 3, 0xB000 | pcOffset(pc + 3, POOL + POOL_SIZE - 1, 9));   // STI R0, MCR pointer
+    emit(pc + 4, 0x0FFF);                                           // BRnzp #-1
+    emit(SUBROUTINE, 0x1B61);                                       // ADD R5, R5, #1
+    emit(SUBROUTINE + 1, 0xC1C0);                                   // RET
+
+    // Pointers, mostly to data but also into the code, the device registers and system space.
+    uint16_t const mmio[] = { KBSR, KBDR, DSR, DDR, PSR };
+    for(uint16_t i = 3; i < POOL_SIZE - 1; i += 1) {
+        uint16_t kind = rand(10);
+        uint16_t value;
+        if(kind < 6) {
+            value = DATA + rand(DATA_SIZE);
+        } else if(kind < 7) {
+            value = CODE + rand(body + 5);
+        } else if(kind < 8) {
+            value = mmio[rand(5)];
+        } else if(kind < 9) {
+            value = 0x0200 + rand(0x100);
+        } else {
+            value = static_cast<uint16_t>(rng());
+        }
+        emit(POOL + i, value);
+    }
+    emit(POOL + POOL_SIZE - 1, MCR);
+
+    for(uint16_t i = 0; i < DATA_SIZE; i += 1) {
+        emit(DATA + i, static_cast<uint16_t>(rng()));
+    }
+
+    for(uint16_t i = 0; i < 8; i += 1) {
+        program.regs[i] = static_cast<uint16_t>(rng());
+    }
+    for(uint16_t i = 1; i <= 3; i += 1) {
+        program.regs[i] = DATA + rand(DATA_SIZE);
+    }
+    program.regs[6] = counter;
+    program.psr = rand(2) ? 0x8002 : 0x0002;
+    program.ignore_privilege = rand(4) == 0;
+    program.drop_privilege = cross && rand(2) == 0;
+    if(program.drop_privilege) {
+        program.psr = 0x0002;
+        program.ignore_privilege = false;
+    }
+
+    return program;
+}
+
+static void load(lc3::core::Simulator & simulator, Program const & program)
+{
+    lc3::core::MachineState & state = simulator.getMachineState();
+    for(auto const & word : program.mem) {
+        state.writeMem(word.first, word.second);
+    }
+    for(uint16_t i = 0; i < 8; i += 1) {
+        state.writeReg(i, program.regs[i]);
+    }
+    state.writePSR(program.psr);
+    state.writeSSP(0x3000);
+    state.writePC(CODE);
+    simulator.setIgnorePrivilege(program.ignore_privilege);
+}
+
+// Runs a program on the engine, stopping after limit instructions of its last run if limit isn't 0.  Returns the
+// number of instructions in the last run, or 0 if a run neither halted nor reached the limit.
+static uint64_t run(lc3::core::Simulator & simulator, Program const & program, lc3::core::EngineType engine,
+    uint64_t limit)
+{
+    simulator.setEngine(engine);
+    if(engine == lc3::core::EngineType::FUNCTIONAL) {
+        // Keeps the reference from running instructions together.
+        simulator.registerCallback(lc3::core::CallbackType::POST_INST,
+            [](lc3::core::CallbackType type, lc3::core::MachineState & state) { (void) type; (void) state; });
+    }
+    load(simulator, program);
+
+    lc3::core::MachineState & state = simulator.getMachineState();
+    lc3::core::RunLimits limits;
+    limits.inst_limit = INST_LIMIT;
+    if(program.drop_privilege) {
+        simulator.setRunLimits(limits);
+        simulator.simulate();
+        if((state.readMCR() & 0x8000) != 0) {
+            return 0;
+        }
+
+        // Whatever was compiled in system mode is kept.
+        state.writePSR(0x8002);
+        state.writeMCR(state.readMCR() | 0x8000);
+        state.writePC(CODE);
+        state.writeReg(6, program.regs[6]);
+    }
+
+    uint64_t const start = simulator.getInstExecCount();
+    limits.inst_limit = limit != 0 ? limit : INST_LIMIT;
+    simulator.setRunLimits(limits);
+    simulator.simulate();
+    if(limit == 0 && (state.readMCR() & 0x8000) != 0) {
+        return 0;
+    }
+    return simulator.getInstExecCount() - start;
+}
+
+static uint32_t compare(lc3::core::Simulator const & expected, lc3::core::Simulator const & actual)
+{
+    lc3::core::MachineState const & lhs = expected.getMachineState();
+    lc3::core::MachineState const & rhs = actual.getMachineState();
+
+    uint32_t diffs = 0;
+    auto check = [&diffs](char const * what, uint32_t where, uint64_t lhs, uint64_t rhs) {
+        if(lhs != rhs) {
+            std::printf("  %s %u: expected 0x%04" PRIx64 ", got 0x%04" PRIx64 "\n", what, where, lhs, rhs);
+            diffs += 1;
+        }
+    };
+
+    check("instructions", 0, expected.getInstExecCount(), actual.getInstExecCount());
+    for(uint16_t i = 0; i < 8; i += 1) {
+        check("R", i, lhs.readReg(i), rhs.readReg(i));
+    }
+    check("PC", 0, lhs.readPC(), rhs.readPC());
+    check("IR", 0, lhs.readIR(), rhs.readIR());
+    check("PSR", 0, lhs.readPSR(), rhs.readPSR());
+    check("MCR", 0, lhs.readMCR(), rhs.readMCR());
+    check("KBSR", 0, std::get<0>(lhs.readMem(KBSR)), std::get<0>(rhs.readMem(KBSR)));
+    check("DSR", 0, std::get<0>(lhs.readMem(DSR)), std::get<0>(rhs.readMem(DSR)));
+    for(uint32_t addr = 0; addr < MMIO_START; addr += 1) {
+        check("mem", addr, std::get<0>(lhs.readMem(addr)), std::get<0>(rhs.readMem(addr)));
+    }
+
+    return diffs;
+}
+
+int main(int argc, char * argv[])
+{
+    if(! lc3::core::sim::Jit::isSupported()) {
+        std::printf("JIT not supported on this platform\n");
+        return 0;
+    }
+
+    uint32_t program_count = 2000;
+    if(argc > 1) {
+        program_count = std::strtoul(argv[1], nullptr, 10);
+    }
+
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+    std::mt19937 rng(0x4C43);
+
+    uint32_t failures = 0, skipped = 0, crossing = 0;
+    uint64_t inst_count = 0, native_count = 0;
+    for(uint32_t i = 0; i < program_count; i += 1) {
+        Program program = generate(rng);
+
+        lc3::core::Simulator expected(printer, inputter, 0);
+        uint64_t const length = run(expected, program, lc3::core::EngineType::FUNCTIONAL, 0);
+        if(length == 0) {
+            skipped += 1;
+            continue;
+        }
+        crossing += program.drop_privilege ? 1 : 0;
+
+        lc3::core::Simulator actual(printer, inputter, 0);
+        run(actual, program, lc3::core::EngineType::JIT, 0);
+
+        inst_count += actual.getInstExecCount();
+        native_count += actual.getJitStats().native_insts;
+        if(compare(expected, actual) != 0) {
+            std::printf("program %u differs\n", i);
+            failures += 1;
+            continue;
+        }
+
+        // Cut the program off part way through its last run.
+        for(uint32_t j = 0; j < CUT_POINTS; j += 1) {
+            uint64_t const limit = 1 + rng() % length;
+            lc3::core::Simulator expected_cut(printer, inputter, 0);
+            run(expected_cut, program, lc3::core::EngineType::FUNCTIONAL, limit);
+            lc3::core::Simulator actual_cut(printer, inputter, 0);
+            run(actual_cut, program, lc3::core::EngineType::JIT, limit);
+            if(compare(expected_cut, actual_cut) != 0) {
+                std::printf("program %u differs when cut off after %" PRIu64 " instructions\n", i, limit);
+                failures += 1;
+                break;
+            }
+        }
+    }
+
+    std::printf("%u programs (%u skipped for not halting, %u run again in user mode), %" PRIu64 " instructions, %"
+        PRIu64 " native\n", program_count, skipped, crossing, inst_count, native_count);
+    if(native_count == 0) {
+        std::printf("no instructions were run natively\n");
+        return 1;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
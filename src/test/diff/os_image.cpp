@@ -0,0 +1,120 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <cinttypes>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "assembler.h"
+#include "device_regs.h"
+#include "inputter.h"
+#include "lc3os.h"
+#include "printer.h"
+#include "simulator.h"
+
+// Checks the OS image that was assembled when the library was built against a fresh assembly of the OS source: the
+// blocks, values, lines, and symbols must all match, and a machine with the image loaded must be the same as one
+// that loaded the freshly assembled object file.
+
+static uint32_t diffs = 0;
+
+static void check(char const * what, uint32_t where, uint64_t expected, uint64_t actual)
+{
+    if(expected != actual) {
+        std::printf("  %s %u: expected 0x%04" PRIx64 ", got 0x%04" PRIx64 "\n", what, where, expected, actual);
+        diffs += 1;
+    }
+}
+
+static void checkLine(char const * what, uint32_t where, std::string const & expected, std::string const & actual)
+{
+    if(expected != actual) {
+        std::printf("  %s %u: expected \"%s\", got \"%s\"\n", what, where, expected.c_str(), actual.c_str());
+        diffs += 1;
+    }
+}
+
+int main(void)
+{
+    lc3::utils::NullPrinter printer;
+    lc3::utils::NullInputter inputter;
+
+    lc3::core::Assembler assembler(printer, 0, false);
+    std::stringstream src_buffer;
+    src_buffer << lc3::core::getOSSrc();
+    std::pair<std::shared_ptr<std::stringstream>, lc3::core::SymbolTable> asm_res = assembler.assemble(src_buffer);
+    std::string const obj = asm_res.first->str();
+
+    // The image only keeps the blocks that fill something.
+    std::stringstream obj_buffer(obj);
+    obj_buffer.ignore(lc3::utils::getMagicHeader().size() + lc3::utils::getVersionString().size());
+    std::vector<std::pair<uint16_t, std::vector<lc3::core::MemLocation>>> blocks;
+    while(true) {
+        lc3::core::MemLocation mem;
+        obj_buffer >> mem;
+        if(obj_buffer.eof()) { break; }
+
+        if(mem.isOrig()) {
+            blocks.emplace_back(mem.getValue(), std::vector<lc3::core::MemLocation>());
+        } else {
+            blocks.back().second.push_back(mem);
+        }
+    }
+
+    lc3::core::OSImage const & image = lc3::core::getOSImage();
+    uint32_t num_blocks = 0;
+    for(auto const & block : blocks) {
+        if(block.second.empty()) { continue; }
+        if(num_blocks >= image.num_blocks) {
+            check("missing block", num_blocks, block.first, 0);
+            break;
+        }
+
+        lc3::core::OSImage::Block const & image_block = image.blocks[num_blocks];
+        check("block start", num_blocks, block.first, image_block.start);
+        check("block size", num_blocks, block.second.size(), image_block.size);
+        for(uint32_t i = 0; i < block.second.size() && i < image_block.size; i += 1) {
+            check("value", block.first + i, block.second[i].getValue(), image_block.values[i]);
+            checkLine("line", block.first + i, block.second[i].getLine(), image_block.lines[i]);
+        }
+        num_blocks += 1;
+    }
+    check("blocks", 0, num_blocks, image.num_blocks);
+
+    lc3::core::SymbolTable const symbols = lc3::core::getOSSymbols();
+    check("symbols", 0, asm_res.second.size(), symbols.size());
+    for(auto const & symbol : asm_res.second) {
+        auto it = symbols.find(symbol.first);
+        if(it == symbols.end()) {
+            std::printf("  symbol %s is missing\n", symbol.first.c_str());
+            diffs += 1;
+        } else {
+            check(symbol.first.c_str(), 0, symbol.second, it->second);
+        }
+    }
+
+    lc3::core::Simulator expected(printer, inputter, 0);
+    std::stringstream load_buffer(obj);
+    expected.loadObj("lc3os", load_buffer);
+    lc3::core::Simulator actual(printer, inputter, 0);
+    actual.loadImage(lc3::core::getOSMemImage());
+
+    lc3::core::MachineState const & lhs = expected.getMachineState();
+    lc3::core::MachineState const & rhs = actual.getMachineState();
+    for(uint16_t i = 0; i < 8; i += 1) {
+        check("R", i, lhs.readReg(i), rhs.readReg(i));
+    }
+    check("PC", 0, lhs.readPC(), rhs.readPC());
+    check("PSR", 0, lhs.readPSR(), rhs.readPSR());
+    check("SSP", 0, lhs.readSSP(), rhs.readSSP());
+    check("reset PC", 0, lhs.readResetPC(), rhs.readResetPC());
+    for(uint32_t addr = 0; addr < MMIO_START; addr += 1) {
+        check("mem", addr, std::get<0>(lhs.readMem(addr)), std::get<0>(rhs.readMem(addr)));
+        checkLine("mem line", addr, lhs.getMemLine(addr), rhs.getMemLine(addr));
+    }
+
+    std::printf("%u blocks, %u symbols, %u differences\n", image.num_blocks, image.num_symbols, diffs);
+    return diffs == 0 ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2020 McGraw-Hill Education. All rights reserved. No reproduction or distribution without the prior written consent of McGraw-Hill Education.
+ */
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+
+#include "inputter.h"
+#include "interface.h"
+#include "printer.h"
+
+// Takes a snapshot inside a subroutine and restores it into a fresh simulator, which must then run the rest of the
+// program as the original would have: the nested call must show the caller from before the snapshot in its stack
+// trace, and returning from both subroutines must not leave more of the stack trace than was entered.
+//
+// Then checks that a snapshot keeps its own copy of everything it shares with the simulators it was taken from and
+// restored into: whatever either writes afterwards, to memory, registers, or device registers, is undone by restoring
+// it, no matter how many times.
+
+class StringPrinter : public lc3::utils::IPrinter
+{
+public:
+    virtual void setColor(lc3::utils::PrintColor color) override { (void) color; }
+    virtual void print(std::string const & string) override { output.append(string); }
+    virtual void newline(void) override { output += '\n'; }
+
+    std::string output;
+};
+
+static uint32_t failures = 0;
+
+static void check(char const * what, uint64_t expected, uint64_t actual)
+{
+    if(expected != actual) {
+        std::printf("  %s: expected 0x%04" PRIx64 ", got 0x%04" PRIx64 "\n", what, expected, actual);
+        failures += 1;
+    }
+}
+
+static void load(lc3::sim & simulator)
+{
+    static uint16_t const program[] = {
+        0x4802,     // x3000  JSR SUB
+        0x4801,     // x3001  JSR SUB
+        0xF025,     // x3002  HALT
+        0x1261,     // x3003  SUB ADD R1, R1, #1
+        0x15E0,     // x3004  ADD R2, R7, #0
+        0x4803,     // x3005  JSR LEAF
+        0x1EA0,     // x3006  ADD R7, R2, #0
+        0xC1C0,     // x3007  RET
+        0x0000,     // x3008
+        0xC1C0,     // x3009  LEAF RET
+    };
+    for(uint16_t i = 0; i < sizeof(program) / sizeof(program[0]); i += 1) {
+        simulator.writeMem(0x3000 + i, program[i]);
+    }
+    simulator.writePC(0x3000);
+}
+
+// Writes to everything a snapshot holds, so that restoring it has something to undo.
+static void scribble(lc3::sim & simulator, uint16_t value)
+{
+    simulator.writeMem(0x4000, value);
+    simulator.writeMem(0x5000, value);
+    simulator.writeReg(3, value);
+    simulator.writePC(value);
+    simulator.writeMem(0xFE00, 0x4000);     // KBSR interrupt enable
+    simulator.writeMem(0xFE04, 0x4000);     // DSR interrupt enable, ready cleared
+    simulator.writePSR(simulator.readPSR() ^ 0x8000);
+    simulator.writeMCR(simulator.readMCR() ^ 0x8000);
+}
+
+static void copyOnWrite(lc3::utils::IPrinter & printer, lc3::utils::IInputter & inputter)
+{
+    lc3::sim original(printer, inputter, 0);
+    load(original);
+    original.writeMem(0x4000, 0x1111);
+    original.writeReg(3, 0x3333);
+    uint16_t const kbsr = original.readMem(0xFE00), dsr = original.readMem(0xFE04);
+    uint16_t const psr = original.readPSR(), mcr = original.readMCR();
+    lc3::core::PMachineSnapshot snapshot = original.snapshot();
+
+    scribble(original, 0x2222);
+    check("original memory after writing", 0x2222, original.readMem(0x4000));
+    check("KBSR after writing", 0x4000, original.readMem(0xFE00));
+    check("DSR after writing", 0x4000, original.readMem(0xFE04));
+
+    lc3::sim other(printer, inputter, 0);
+    other.restore(snapshot);
+    check("memory restored after the original wrote", 0x1111, other.readMem(0x4000));
+    check("register restored after the original wrote", 0x3333, other.readReg(3));
+    scribble(other, 0x5555);
+    check("original memory after the other wrote", 0x2222, original.readMem(0x4000));
+    check("original memory on a page only the other wrote", 0x2222, original.readMem(0x5000));
+
+    // Restoring the same snapshot again, into either simulator, undoes everything written since.
+    for(uint32_t i = 0; i < 2; i += 1) {
+        lc3::sim & simulator = i == 0 ? original : other;
+        for(uint32_t round = 0; round < 2; round += 1) {
+            simulator.restore(snapshot);
+            check("memory", 0x1111, simulator.readMem(0x4000));
+            check("memory on a page written after the snapshot", 0, simulator.readMem(0x5000));
+            check("register", 0x3333, simulator.readReg(3));
+            check("PC", 0x3000, simulator.readPC());
+            check("KBSR", kbsr, simulator.readMem(0xFE00));
+            check("DSR", dsr, simulator.readMem(0xFE04));
+            check("PSR", psr, simulator.readPSR());
+            check("MCR", mcr, simulator.readMCR());
+            scribble(simulator, static_cast<uint16_t>(0x6666 + round));
+        }
+    }
+}
+
+int main(void)
+{
+    StringPrinter quiet_printer;
+    lc3::utils::NullInputter inputter;
+
+    lc3::sim original(quiet_printer, inputter, 0);
+    load(original);
+    original.stepIn();
+    check("PC in subroutine", 0x3003, original.readPC());
+    lc3::core::PMachineSnapshot snapshot = original.snapshot();
+
+    // The stack trace is only printed at the debug level.
+    StringPrinter printer;
+    lc3::sim restored(printer, inputter, static_cast<uint32_t>(lc3::utils::PrintType::P_DEBUG));
+    restored.restore(snapshot);
+    check("PC after restore", 0x3003, restored.readPC());
+
+    printer.output.clear();
+    restored.stepIn();
+    restored.stepIn();
+    restored.stepIn();
+    check("PC in nested subroutine", 0x3009, restored.readPC());
+    if(printer.output.find("#1 0x3000") == std::string::npos) {
+        std::printf("  stack trace in nested subroutine is missing the call from before the snapshot\n");
+        failures += 1;
+    }
+
+    // Returns from both subroutines, calls the first again, and stops before the HALT.
+    restored.runUntilHalt();
+    check("PC at HALT", 0x3002, restored.readPC());
+    check("R1", 2, restored.readReg(1));
+
+    copyOnWrite(quiet_printer, inputter);
+
+    std::printf("%u failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
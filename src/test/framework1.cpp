@@ -112,6 +112,9 @@ int main(int argc, char * argv[])
     uint32_t total_possible_points = 0;
 
     if(valid_program) {
+        // Machines that aren't randomized all start out the same, so the program is only loaded once and restored
+        // from a snapshot after that.  Randomized machines get a new seed every time.
+        lc3::core::PMachineSnapshot loaded_image;
         for(TestCase const & test : tests) {
             BufferedPrinter sim_printer(args.print_output);
             StringInputter sim_inputter;
@@ -128,11 +131,18 @@ int main(int argc, char * argv[])
                 std::cout << " (Randomized Machine)";
             }
             std::cout << std::endl;
-            for(std::string const & obj_filename : obj_filenames) {
-                auto res = simulator.loadObjFile(obj_filename);
-                if(!res.first) {
-                    std::cout << "could not init simulator\n";
-                    return 2;
+            if(! test.randomize && loaded_image != nullptr) {
+                simulator.restore(loaded_image);
+            } else {
+                for(std::string const & obj_filename : obj_filenames) {
+                    auto res = simulator.loadObjFile(obj_filename);
+                    if(!res.first) {
+                        std::cout << "could not init simulator\n";
+                        return 2;
+                    }
+                }
+                if(! test.randomize) {
+                    loaded_image = simulator.snapshot();
                 }
             }
 
@@ -190,25 +190,34 @@ std::pair<double, double> Tester::testSingle(TestCase const & test)
     this->inputter = &inputter;
     this->simulator = &simulator;
 
+    lc3::core::PMachineSnapshot & image = test.randomize ? randomized_image : loaded_image;
+
     std::cout << "==========\n";
     std::cout << "Test: " << test.name;
 
     if(test.randomize) {
-        if(seed == 0) {
-            seed = simulator.randomizeState();
-        } else {
-            simulator.randomizeState(seed);
+        if(image == nullptr) {
+            if(seed == 0) {
+                seed = simulator.randomizeState();
+            } else {
+                simulator.randomizeState(seed);
+            }
         }
         std::cout << " (Randomized Machine, Seed: " << seed << ")";
     }
     std::cout << std::endl;
 
-    for(std::string const & obj_filename : obj_filenames) {
-        auto res = simulator.loadObjFile(obj_filename);
-        if(!res.first) {
-            std::cout << "Could not init simulator\n";
-            return std::make_pair(0, test.points);
+    if(image != nullptr) {
+        simulator.restore(image);
+    } else {
+        for(std::string const & obj_filename : obj_filenames) {
+            auto res = simulator.loadObjFile(obj_filename);
+            if(!res.first) {
+                std::cout << "Could not init simulator\n";
+                return std::make_pair(0, test.points);
+            }
         }
+        image = simulator.snapshot();
     }
 
     testBringup(simulator);
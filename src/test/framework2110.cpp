@@ -213,12 +213,17 @@ void Tester::testSingle(TestCase const &test) {
 
   curr_test_result.test_name = test.name;
 
+  lc3::core::PMachineSnapshot &image =
+      test.randomizeSeed >= 0 ? randomized_image : loaded_image;
+
   // seed cli arg >> test.randomizeSeed
   if (test.randomizeSeed >= 0) {
-    if (seed == 0) {
-      seed = simulator.randomizeState(test.randomizeSeed);
-    } else {
-      simulator.randomizeState(seed);
+    if (image == nullptr) {
+      if (seed == 0) {
+        seed = simulator.randomizeState(test.randomizeSeed);
+      } else {
+        simulator.randomizeState(seed);
+      }
     }
     curr_test_result.seed = seed;
   } else {
@@ -226,12 +231,17 @@ void Tester::testSingle(TestCase const &test) {
     curr_test_result.seed = -1;
   }
 
-  for (std::string const &obj_filename : obj_filenames) {
-    auto res = simulator.loadObjFile(obj_filename);
-    if (!res.first) {
-      error("Simulator initialization failed", res.second);
-      return;
+  if (image != nullptr) {
+    simulator.restore(image);
+  } else {
+    for (std::string const &obj_filename : obj_filenames) {
+      auto res = simulator.loadObjFile(obj_filename);
+      if (!res.first) {
+        error("Simulator initialization failed", res.second);
+        return;
+      }
     }
+    image = simulator.snapshot();
   }
 
   testBringup(simulator);
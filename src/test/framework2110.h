@@ -51,6 +51,10 @@ private:
   uint64_t seed;
   std::vector<std::string> obj_filenames;
   lc3::core::SymbolTable symbol_table;
+  // Every test starts from one of two machines, with or without randomization
+  // (the seed is kept once chosen), so each is only loaded once and restored
+  // from a snapshot after that.
+  lc3::core::PMachineSnapshot loaded_image, randomized_image;
 
   BufferedPrinter *printer;
   StringInputter *inputter;
@@ -17,6 +17,14 @@ void BufferedPrinter::print(std::string const & string)
     }
 }
 
+void BufferedPrinter::printChars(char const * chars, size_t count)
+{
+    display_buffer.insert(display_buffer.end(), chars, chars + count);
+    if(print_output) {
+        std::cout.write(chars, count);
+    }
+}
+
 void BufferedPrinter::newline(void)
 {
     display_buffer.push_back('\n');
@@ -16,6 +16,7 @@ public:
     virtual void setColor(lc3::utils::PrintColor color) override { (void) color; }
     virtual void print(std::string const & string) override;
     virtual void newline(void) override;
+    virtual void printChars(char const * chars, size_t count) override;
     void clear(void) { display_buffer.clear(); }
     std::vector<char> const & getBuffer(void) const { return display_buffer; }
 